@@ -15,6 +15,8 @@
 
 #define DEFAULT_INDEX ((const size_t) - 1ULL)
 
+static float animation_time_scale = 1.0f;
+
 float ease(const float time, const enum Easing easing);
 
 struct Animation *create_animation(const size_t action_count) {
@@ -86,7 +88,7 @@ void restart_animation(struct Animation *const animation, const size_t action_in
 
 static void apply_action(struct Action *const action, const float value);
 
-void update_animation(struct Animation *const animation, const double delta_time) {
+static void advance_animation(struct Animation *const animation, const double delta_time) {
         if (!animation->active) {
                 return;
         }
@@ -116,7 +118,7 @@ void update_animation(struct Animation *const animation, const double delta_time
                 }
 
                 start_action(&animation->actions[animation->action_index]);
-                update_animation(animation, current_action->duration - elapsed);
+                advance_animation(animation, current_action->duration - elapsed);
                 return;
         }
 
@@ -125,6 +127,26 @@ void update_animation(struct Animation *const animation, const double delta_time
         apply_action(current_action, value);
 }
 
+void update_animation(struct Animation *const animation, const double delta_time) {
+        advance_animation(animation, delta_time * (double)animation_time_scale);
+}
+
+void finish_animation(struct Animation *const animation) {
+        // Every action that is left gets just enough time to complete, the ones waiting behind a pause are left alone
+        while (animation->active) {
+                const struct Action *const current_action = &animation->actions[animation->action_index];
+                advance_animation(animation, (double)(current_action->delay + current_action->duration - current_action->elapsed) + 1.0);
+        }
+}
+
+void set_animation_time_scale(const float time_scale) {
+        animation_time_scale = fmaxf(time_scale, 0.0f);
+}
+
+float get_animation_time_scale(void) {
+        return animation_time_scale;
+}
+
 static void start_action(struct Action *const action) {
         if (!action->lazy_start) {
                 return;
@@ -76,4 +76,12 @@ void reset_animation(struct Animation *const animation);
 
 void update_animation(struct Animation *const animation, const double delta_time);
 
+// Runs the animation to the end of its current actions right away, as if enough time had passed
+void finish_animation(struct Animation *const animation);
+
+// Every animation advances by the delta time multiplied by this scale, which is 1 by default
+void set_animation_time_scale(const float time_scale);
+
+float get_animation_time_scale(void);
+
 void restart_animation(struct Animation *const animation, const size_t action_index);
\ No newline at end of file
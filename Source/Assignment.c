@@ -0,0 +1,149 @@
+#include "Assignment.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "Defines.h"
+#include "Memory.h"
+#include "Debug.h"
+
+void initialize_assignment(struct Assignment *const assignment, const uint16_t row_count, const uint16_t column_count) {
+        ASSERT_ALL(row_count <= column_count);
+
+        assignment->row_count = row_count;
+        assignment->column_count = column_count;
+        assignment->total_cost = 0;
+        assignment->row_potentials = (int32_t *)xcalloc((size_t)row_count + 1ULL, sizeof(int32_t));
+        assignment->column_potentials = (int32_t *)xcalloc((size_t)column_count + 1ULL, sizeof(int32_t));
+        assignment->column_rows = (uint16_t *)xcalloc((size_t)column_count + 1ULL, sizeof(uint16_t));
+        assignment->column_ways = (uint16_t *)xcalloc((size_t)column_count + 1ULL, sizeof(uint16_t));
+        assignment->column_minimums = (int32_t *)xcalloc((size_t)column_count + 1ULL, sizeof(int32_t));
+        assignment->column_visits = (bool *)xcalloc((size_t)column_count + 1ULL, sizeof(bool));
+}
+
+void deinitialize_assignment(struct Assignment *const assignment) {
+        xfree(assignment->column_visits);
+        xfree(assignment->column_minimums);
+        xfree(assignment->column_ways);
+        xfree(assignment->column_rows);
+        xfree(assignment->column_potentials);
+        xfree(assignment->row_potentials);
+}
+
+static inline int32_t get_assignment_cost(const struct Assignment *const assignment, const int32_t *const costs, const uint16_t row, const uint16_t column) {
+        return costs[(size_t)(row - 1) * assignment->column_count + (column - 1)];
+}
+
+int32_t solve_assignment(struct Assignment *const assignment, const int32_t *const costs) {
+        const uint16_t row_count = assignment->row_count;
+        const uint16_t column_count = assignment->column_count;
+
+        int32_t *const row_potentials = assignment->row_potentials;
+        int32_t *const column_potentials = assignment->column_potentials;
+        uint16_t *const column_rows = assignment->column_rows;
+        uint16_t *const column_ways = assignment->column_ways;
+        int32_t *const column_minimums = assignment->column_minimums;
+        bool *const column_visits = assignment->column_visits;
+
+        memset(row_potentials, 0, ((size_t)row_count + 1ULL) * sizeof(int32_t));
+        memset(column_potentials, 0, ((size_t)column_count + 1ULL) * sizeof(int32_t));
+        memset(column_rows, 0, ((size_t)column_count + 1ULL) * sizeof(uint16_t));
+
+        // Every row is added along the cheapest augmenting path, which is found like with Dijkstra's algorithm over the
+        // reduced costs. Column zero stands in for the row that is being added
+        for (uint16_t row = 1; row <= row_count; ++row) {
+                column_rows[0] = row;
+                uint16_t column = 0;
+
+                for (uint16_t index = 0; index <= column_count; ++index) {
+                        column_minimums[index] = ASSIGNMENT_COST_NONE;
+                        column_visits[index] = false;
+                }
+
+                do {
+                        column_visits[column] = true;
+                        const uint16_t visited_row = column_rows[column];
+
+                        int32_t delta = ASSIGNMENT_COST_NONE;
+                        uint16_t next_column = 0;
+                        for (uint16_t index = 1; index <= column_count; ++index) {
+                                if (column_visits[index]) {
+                                        continue;
+                                }
+
+                                const int32_t reduced_cost = get_assignment_cost(assignment, costs, visited_row, index) - row_potentials[visited_row] - column_potentials[index];
+                                if (reduced_cost < column_minimums[index]) {
+                                        column_minimums[index] = reduced_cost;
+                                        column_ways[index] = column;
+                                }
+
+                                if (column_minimums[index] < delta) {
+                                        delta = column_minimums[index];
+                                        next_column = index;
+                                }
+                        }
+
+                        for (uint16_t index = 0; index <= column_count; ++index) {
+                                if (column_visits[index]) {
+                                        row_potentials[column_rows[index]] += delta;
+                                        column_potentials[index] -= delta;
+                                } else {
+                                        column_minimums[index] -= delta;
+                                }
+                        }
+
+                        column = next_column;
+                } while (column_rows[column] != 0);
+
+                // Flips the path so that every column on it takes over the row of the column before it
+                do {
+                        const uint16_t previous_column = column_ways[column];
+                        column_rows[column] = column_rows[previous_column];
+                        column = previous_column;
+                } while (column != 0);
+        }
+
+        assignment->total_cost = 0;
+        for (uint16_t column = 1; column <= column_count; ++column) {
+                if (column_rows[column] != 0) {
+                        assignment->total_cost += get_assignment_cost(assignment, costs, column_rows[column], column);
+                }
+        }
+
+        return assignment->total_cost;
+}
+
+// The assignment stays the cheapest as long as the potentials stay feasible for the new costs: no reduced cost may be
+// negative, the assigned pairs have to stay tight and only assigned columns may have a negative potential
+bool query_assignment_column_change(
+        const struct Assignment *const assignment,
+        const int32_t *const costs,
+        const uint16_t column,
+        const int32_t *const column_costs,
+        int32_t *const out_total_cost
+) {
+        const uint16_t assigned_row = assignment->column_rows[column + 1];
+
+        int32_t column_potential = 0;
+        if (assigned_row != 0) {
+                column_potential = column_costs[assigned_row - 1] - assignment->row_potentials[assigned_row];
+                if (column_potential > 0) {
+                        return false;
+                }
+        }
+
+        for (uint16_t row = 1; row <= assignment->row_count; ++row) {
+                if (assignment->row_potentials[row] + column_potential > column_costs[row - 1]) {
+                        return false;
+                }
+        }
+
+        *out_total_cost = assignment->total_cost;
+        if (assigned_row != 0) {
+                *out_total_cost += column_costs[assigned_row - 1] - get_assignment_cost(assignment, costs, assigned_row, (uint16_t)(column + 1));
+        }
+
+        return true;
+}
\ No newline at end of file
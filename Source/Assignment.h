@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+// Minimum cost assignments of rows to distinct columns with the Hungarian algorithm, there have to be at least as many
+// columns as rows. Besides the assignment, the row and column potentials of the dual are kept, which is what allows
+// checking in linear time whether the assignment is still the cheapest after the costs of a single column changed.
+//
+// Everything is indexed from one like in the usual write-up of the algorithm, index zero is a sentinel
+
+#define ASSIGNMENT_COST_NONE INT32_MAX
+
+struct Assignment {
+        uint16_t row_count;
+        uint16_t column_count;
+        int32_t total_cost;
+        int32_t *row_potentials;
+        int32_t *column_potentials;
+        uint16_t *column_rows;
+        uint16_t *column_ways;
+        int32_t *column_minimums;
+        bool *column_visits;
+};
+
+void initialize_assignment(struct Assignment *const assignment, const uint16_t row_count, const uint16_t column_count);
+
+void deinitialize_assignment(struct Assignment *const assignment);
+
+// The costs are laid out by row, 'costs[row * column_count + column]' with both counted from zero. Returns the total
+// cost of the cheapest assignment, which is also kept in the assignment
+int32_t solve_assignment(struct Assignment *const assignment, const int32_t *const costs);
+
+// Checks whether the solved assignment stays the cheapest when the costs of one column (counted from zero) are
+// replaced by the given ones, one per row. On success, the total cost with the replaced column is given back and the
+// assignment itself is left alone, so that the same solved assignment can be checked against several changes
+bool query_assignment_column_change(
+        const struct Assignment *const assignment,
+        const int32_t *const costs,
+        const uint16_t column,
+        const int32_t *const column_costs,
+        int32_t *const out_total_cost
+);
\ No newline at end of file
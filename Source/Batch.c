@@ -0,0 +1,179 @@
+#include "Batch.h"
+
+#include <string.h>
+
+#include "Memory.h"
+#include "Defines.h"
+#include "Debug.h"
+
+_Static_assert(sizeof(struct Bitboard) == BITBOARD_WORD_COUNT * sizeof(uint64_t), "Observation planes aren't laid out like bitboards");
+
+// Counted from scratch every step, which only takes a look at every block and is never more than a handful of them
+static inline bool is_level_batch_instance_deadlocked(const struct LevelBatchInstance *const instance) {
+        const struct LevelState *const state = &instance->state;
+
+        uint16_t dead_block_count = 0;
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                const struct EntityState *const entity = &state->entities[entity_index];
+                if (entity->type != ENTITY_BLOCK) {
+                        continue;
+                }
+
+                const struct Bitboard *const dead_tiles = state->group_indices[entity_index] == GROUP_INDEX_NONE ? &instance->dead_tiles : &instance->joined_dead_tiles;
+                if (bitboard_test(dead_tiles, (uint16_t)(entity->row * state->columns + entity->column))) {
+                        ++dead_block_count;
+                }
+        }
+
+        return instance->block_count - dead_block_count < state->spot_count;
+}
+
+static inline uint8_t query_level_batch_instance_flags(struct LevelBatchInstance *const instance) {
+        uint8_t flags = 0;
+        if (is_level_state_won(&instance->state)) {
+                flags |= LEVEL_BATCH_FLAG_WON | LEVEL_BATCH_FLAG_DONE;
+        } else if (is_level_batch_instance_deadlocked(instance)) {
+                flags |= LEVEL_BATCH_FLAG_DEADLOCKED | LEVEL_BATCH_FLAG_DONE;
+        }
+
+        instance->done = (flags & LEVEL_BATCH_FLAG_DONE) != 0;
+        return flags;
+}
+
+static inline void observe_level_batch_instance(const struct LevelBatchInstance *const instance, uint64_t *const out_observation) {
+        struct Bitboard *const planes = (struct Bitboard *)out_observation;
+        memcpy(planes, instance->static_planes, sizeof(instance->static_planes));
+        memset(&planes[LEVEL_BATCH_FIRST_DYNAMIC_PLANE], 0, (LEVEL_BATCH_PLANE_COUNT - LEVEL_BATCH_FIRST_DYNAMIC_PLANE) * sizeof(struct Bitboard));
+
+        const struct LevelState *const state = &instance->state;
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                const struct EntityState *const entity = &state->entities[entity_index];
+                const uint16_t tile_index = (uint16_t)(entity->row * state->columns + entity->column);
+
+                if (entity->type == ENTITY_BLOCK) {
+                        bitboard_set(&planes[LEVEL_BATCH_PLANE_BLOCKS], tile_index);
+
+                        if (state->group_indices[entity_index] != GROUP_INDEX_NONE) {
+                                bitboard_set(&planes[LEVEL_BATCH_PLANE_JOINED_BLOCKS], tile_index);
+                        }
+
+                        continue;
+                }
+
+                bitboard_set(&planes[LEVEL_BATCH_PLANE_PLAYERS], tile_index);
+
+                if (entity_index == state->current_player_index) {
+                        bitboard_set(&planes[LEVEL_BATCH_PLANE_CURRENT_PLAYER], tile_index);
+                }
+
+                for (uint8_t bit = 0; bit < 3; ++bit) {
+                        if (entity->orientation & (1U << bit)) {
+                                bitboard_set(&planes[LEVEL_BATCH_PLANE_ORIENTATION_0 + bit], tile_index);
+                        }
+                }
+        }
+}
+
+void initialize_level_batch(struct LevelBatch *const batch, const struct LevelState *const *const states, const size_t instance_count, const size_t maximum_depth) {
+        ASSERT_ALL(batch != NULL, states != NULL || instance_count == 0ULL);
+
+        batch->instance_count = instance_count;
+        batch->instances = (struct LevelBatchInstance *)xcalloc(MAXIMUM_VALUE(instance_count, 1ULL), sizeof(struct LevelBatchInstance));
+
+        for (size_t instance_index = 0ULL; instance_index < instance_count; ++instance_index) {
+                struct LevelBatchInstance *const instance = &batch->instances[instance_index];
+                const struct LevelState *const state = states[instance_index];
+                copy_level_state(state, &instance->state);
+
+                // Stepping never allocates and nothing reads a trail, which would be the biggest part of a short history
+                initialize_step_history(&instance->step_history, state, MAXIMUM_VALUE(maximum_depth, 1ULL), STEP_HISTORY_FLAG_PREALLOCATE);
+                instance->initial_entities = (struct EntityState *)xmalloc(MAXIMUM_VALUE((size_t)state->entity_count, 1ULL) * sizeof(struct EntityState));
+                save_level_state(state, instance->initial_entities, &instance->initial_player_index);
+                instance->change_buffer = (struct Change *)xmalloc(get_level_state_change_limit(state) * sizeof(struct Change));
+                instance->switch_anchor_player_index = ENTITY_INDEX_NONE;
+
+                // Instances of the same level come in runs more often than not, and working out the dead tiles is the
+                // slow part of setting up an instance
+                if (instance_index > 0ULL && states[instance_index - 1ULL] == state) {
+                        const struct LevelBatchInstance *const previous_instance = &batch->instances[instance_index - 1ULL];
+                        memcpy(instance->static_planes, previous_instance->static_planes, sizeof(instance->static_planes));
+                        instance->dead_tiles = previous_instance->dead_tiles;
+                        instance->joined_dead_tiles = previous_instance->joined_dead_tiles;
+                        instance->block_count = previous_instance->block_count;
+                        continue;
+                }
+
+                struct LevelBitboards bitboards;
+                populate_level_bitboards(&bitboards, state);
+                query_level_bitboards_dead_tiles(&bitboards, &instance->dead_tiles, &instance->joined_dead_tiles);
+
+                instance->static_planes[LEVEL_BATCH_PLANE_PLAYER_FLOOR] = bitboards.player_floor;
+                instance->static_planes[LEVEL_BATCH_PLANE_SLABS] = bitboards.slabs;
+                instance->static_planes[LEVEL_BATCH_PLANE_SPOTS] = bitboards.spots;
+                instance->static_planes[LEVEL_BATCH_PLANE_DEAD_TILES] = instance->dead_tiles;
+                instance->block_count = (uint16_t)bitboard_count(&bitboards.blocks);
+        }
+}
+
+void deinitialize_level_batch(struct LevelBatch *const batch) {
+        for (size_t instance_index = 0ULL; instance_index < batch->instance_count; ++instance_index) {
+                struct LevelBatchInstance *const instance = &batch->instances[instance_index];
+                xfree(instance->change_buffer);
+                xfree(instance->initial_entities);
+                deinitialize_step_history(&instance->step_history);
+                deinitialize_level_state(&instance->state);
+        }
+
+        xfree(batch->instances);
+        batch->instances = NULL;
+        batch->instance_count = 0ULL;
+}
+
+void reset_level_batch(struct LevelBatch *const batch, uint64_t *const out_observations, uint8_t *const out_flags) {
+        for (size_t instance_index = 0ULL; instance_index < batch->instance_count; ++instance_index) {
+                struct LevelBatchInstance *const instance = &batch->instances[instance_index];
+                restart_step_history(&instance->step_history, &instance->state, instance->initial_entities, instance->initial_player_index, &instance->switch_anchor_player_index);
+
+                const uint8_t flags = query_level_batch_instance_flags(instance) | LEVEL_BATCH_FLAG_RESTARTED;
+                if (out_flags != NULL) {
+                        out_flags[instance_index] = flags;
+                }
+
+                if (out_observations != NULL) {
+                        observe_level_batch_instance(instance, &out_observations[instance_index * LEVEL_BATCH_OBSERVATION_WORD_COUNT]);
+                }
+        }
+}
+
+void step_level_batch(struct LevelBatch *const batch, const enum Input *const inputs, uint64_t *const out_observations, uint8_t *const out_flags) {
+        ASSERT_ALL(batch != NULL, inputs != NULL);
+
+        for (size_t instance_index = 0ULL; instance_index < batch->instance_count; ++instance_index) {
+                struct LevelBatchInstance *const instance = &batch->instances[instance_index];
+
+                uint8_t flags = 0;
+                if (instance->done) {
+                        restart_step_history(&instance->step_history, &instance->state, instance->initial_entities, instance->initial_player_index, &instance->switch_anchor_player_index);
+                        flags |= LEVEL_BATCH_FLAG_RESTARTED;
+                }
+
+                // Any input ends a run of switches, so playing nothing has to skip the step rules altogether
+                const enum Input input = inputs[instance_index];
+                if (input < INPUT_NONE) {
+                        struct StepOutcome outcome;
+                        step_history_play_input(&instance->step_history, &instance->state, &instance->switch_anchor_player_index, input, ENTITY_INDEX_NONE, instance->change_buffer, &outcome);
+                        if (outcome.changed) {
+                                flags |= LEVEL_BATCH_FLAG_CHANGED;
+                        }
+                }
+
+                flags |= query_level_batch_instance_flags(instance);
+                if (out_flags != NULL) {
+                        out_flags[instance_index] = flags;
+                }
+
+                if (out_observations != NULL) {
+                        observe_level_batch_instance(instance, &out_observations[instance_index * LEVEL_BATCH_OBSERVATION_WORD_COUNT]);
+                }
+        }
+}
\ No newline at end of file
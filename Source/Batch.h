@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "Bitboard.h"
+#include "History.h"
+#include "State.h"
+
+// Steps many instances of levels in lockstep without any SDL, for agents that play the levels to tune them. Every
+// instance plays its inputs with the same step rules as the level and the replays, and every step writes what the
+// instances look like into buffers that the caller owns. The step histories are allocated for their whole depth up
+// front and keep no trail, so nothing is allocated after initializing, and since the instances share nothing a batch
+// can be stepped on any thread, one thread per batch.
+//
+// The observation of an instance is 'LEVEL_BATCH_PLANE_COUNT' planes of 'BITBOARD_WORD_COUNT' words each, laid out
+// like a bitboard of the level ('row * columns + column'). The instances are back to back, the observation of instance
+// 'i' starts at word 'i * LEVEL_BATCH_OBSERVATION_WORD_COUNT'
+
+enum LevelBatchPlane {
+        LEVEL_BATCH_PLANE_PLAYER_FLOOR,  // Cells, spots and slabs
+        LEVEL_BATCH_PLANE_SLABS,
+        LEVEL_BATCH_PLANE_SPOTS,
+        LEVEL_BATCH_PLANE_DEAD_TILES,    // Tiles a loose block can never leave for a spot again
+        LEVEL_BATCH_PLANE_BLOCKS,
+        LEVEL_BATCH_PLANE_JOINED_BLOCKS,
+        LEVEL_BATCH_PLANE_PLAYERS,
+        LEVEL_BATCH_PLANE_CURRENT_PLAYER,
+        LEVEL_BATCH_PLANE_ORIENTATION_0, // The orientation of every player is spread over three planes, one bit each
+        LEVEL_BATCH_PLANE_ORIENTATION_1,
+        LEVEL_BATCH_PLANE_ORIENTATION_2,
+        LEVEL_BATCH_PLANE_COUNT
+};
+
+// Only the planes from here on change while playing
+#define LEVEL_BATCH_FIRST_DYNAMIC_PLANE LEVEL_BATCH_PLANE_BLOCKS
+
+#define LEVEL_BATCH_OBSERVATION_WORD_COUNT ((size_t)LEVEL_BATCH_PLANE_COUNT * BITBOARD_WORD_COUNT)
+
+enum LevelBatchFlag {
+        LEVEL_BATCH_FLAG_CHANGED    = 1 << 0, // The input had an effect
+        LEVEL_BATCH_FLAG_WON        = 1 << 1,
+        LEVEL_BATCH_FLAG_DEADLOCKED = 1 << 2, // Too few blocks can still reach a spot, though undoing can get out of it
+        LEVEL_BATCH_FLAG_DONE       = 1 << 3, // Won or deadlocked
+        LEVEL_BATCH_FLAG_RESTARTED  = 1 << 4  // The instance was done and got restarted before the input
+};
+
+struct LevelBatchInstance {
+        struct LevelState state;
+        struct StepHistory step_history;
+        struct EntityState *initial_entities;
+        uint16_t initial_player_index;
+        struct Change *change_buffer;
+        uint16_t switch_anchor_player_index;
+        struct Bitboard static_planes[LEVEL_BATCH_FIRST_DYNAMIC_PLANE];
+        struct Bitboard dead_tiles;
+        struct Bitboard joined_dead_tiles;
+        uint16_t block_count;
+        bool done;
+};
+
+struct LevelBatch {
+        size_t instance_count;
+        struct LevelBatchInstance *instances;
+};
+
+// Instance 'i' plays 'states[i]', which has to be a level state that was just loaded and is copied, so the same state
+// can be given for any number of instances. The step history of every instance keeps at most 'maximum_depth' steps
+void initialize_level_batch(struct LevelBatch *const batch, const struct LevelState *const *const states, const size_t instance_count, const size_t maximum_depth);
+
+void deinitialize_level_batch(struct LevelBatch *const batch);
+
+// Restarts every instance and writes where they start out, either buffer can be NULL
+void reset_level_batch(struct LevelBatch *const batch, uint64_t *const out_observations, uint8_t *const out_flags);
+
+// Plays 'inputs[i]' on instance 'i', INPUT_NONE plays nothing. An instance that was done after the step before is
+// restarted first, so the lockstep never waits on any instance. Either buffer can be NULL
+void step_level_batch(struct LevelBatch *const batch, const enum Input *const inputs, uint64_t *const out_observations, uint8_t *const out_flags);
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include "Bitboard.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "Hexagons.h"
+#include "State.h"
+
+void initialize_bitboard_shifts(struct BitboardShifts *const shifts, const uint8_t columns, const uint8_t rows) {
+        memset(shifts, 0, sizeof(struct BitboardShifts));
+        shifts->columns = columns;
+        shifts->rows = rows;
+
+        for (uint8_t row = 0; row < rows; ++row) {
+                for (uint8_t column = 0; column < columns; ++column) {
+                        const uint16_t tile_index = (uint16_t)(row * columns + column);
+                        bitboard_set(&shifts->grid, tile_index);
+
+                        for (int direction = 0; direction < ORIENTATION_COUNT; ++direction) {
+                                size_t neighbor_column, neighbor_row;
+                                if (!orientation_advance((enum Orientation)direction, column, row, columns, rows, &neighbor_column, &neighbor_row)) {
+                                        continue;
+                                }
+
+                                // The offset is the same for every tile of the same column parity
+                                const uint16_t neighbor_index = (uint16_t)(neighbor_row * columns + neighbor_column);
+                                shifts->offsets[direction][column & 1] = (int16_t)((int)neighbor_index - (int)tile_index);
+                                bitboard_set(&shifts->masks[direction][column & 1], tile_index);
+                        }
+                }
+        }
+}
+
+static inline void shift_words(const struct Bitboard *const bitboard, const int offset, struct Bitboard *const out) {
+        const size_t distance = (size_t)(offset < 0 ? -offset : offset);
+        const size_t word_shift = distance / BITBOARD_WORD_BITS;
+        const size_t bit_shift = distance % BITBOARD_WORD_BITS;
+
+        for (size_t index = 0ULL; index < BITBOARD_WORD_COUNT; ++index) {
+                uint64_t word = 0;
+
+                if (offset >= 0) {
+                        if (index >= word_shift) {
+                                word |= bitboard->words[index - word_shift] << bit_shift;
+                        }
+
+                        if (bit_shift != 0ULL && index >= word_shift + 1ULL) {
+                                word |= bitboard->words[index - word_shift - 1ULL] >> (BITBOARD_WORD_BITS - bit_shift);
+                        }
+                } else {
+                        if (index + word_shift < BITBOARD_WORD_COUNT) {
+                                word |= bitboard->words[index + word_shift] >> bit_shift;
+                        }
+
+                        if (bit_shift != 0ULL && index + word_shift + 1ULL < BITBOARD_WORD_COUNT) {
+                                word |= bitboard->words[index + word_shift + 1ULL] << (BITBOARD_WORD_BITS - bit_shift);
+                        }
+                }
+
+                out->words[index] = word;
+        }
+}
+
+void bitboard_shift(const struct BitboardShifts *const shifts, const struct Bitboard *const bitboard, const enum Orientation direction, struct Bitboard *const out) {
+        struct Bitboard result = {0};
+
+        for (int parity = 0; parity < 2; ++parity) {
+                struct Bitboard masked, shifted;
+                bitboard_and(bitboard, &shifts->masks[direction][parity], &masked);
+                shift_words(&masked, shifts->offsets[direction][parity], &shifted);
+                bitboard_or(&result, &shifted, &result);
+        }
+
+        *out = result;
+}
+
+void bitboard_flood(const struct BitboardShifts *const shifts, const struct Bitboard *const start, const struct Bitboard *const passable, struct Bitboard *const out) {
+        struct Bitboard flooded;
+        bitboard_and(start, passable, &flooded);
+
+        while (true) {
+                struct Bitboard grown = flooded;
+                for (int direction = 0; direction < ORIENTATION_COUNT; ++direction) {
+                        struct Bitboard shifted;
+                        bitboard_shift(shifts, &flooded, (enum Orientation)direction, &shifted);
+                        bitboard_or(&grown, &shifted, &grown);
+                }
+
+                bitboard_and(&grown, passable, &grown);
+                if (bitboard_equals(&grown, &flooded)) {
+                        break;
+                }
+
+                flooded = grown;
+        }
+
+        *out = flooded;
+}
+
+void populate_level_bitboards(struct LevelBitboards *const bitboards, const struct LevelState *const state) {
+        memset(bitboards, 0, sizeof(struct LevelBitboards));
+        initialize_bitboard_shifts(&bitboards->shifts, state->columns, state->rows);
+
+        for (uint16_t tile_index = 0; tile_index < state->tile_count; ++tile_index) {
+                switch (state->tiles[tile_index]) {
+                        case TILE_SPOT: {
+                                bitboard_set(&bitboards->spots, tile_index);
+                                bitboard_set(&bitboards->block_floor, tile_index);
+                                bitboard_set(&bitboards->player_floor, tile_index);
+                                break;
+                        }
+
+                        case TILE_CELL: {
+                                bitboard_set(&bitboards->block_floor, tile_index);
+                                bitboard_set(&bitboards->player_floor, tile_index);
+                                break;
+                        }
+
+                        case TILE_SLAB: {
+                                bitboard_set(&bitboards->slabs, tile_index);
+                                bitboard_set(&bitboards->player_floor, tile_index);
+                                break;
+                        }
+
+                        default: {
+                                break;
+                        }
+                }
+        }
+
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                const struct EntityState *const entity = &state->entities[entity_index];
+                const uint16_t tile_index = (uint16_t)(entity->row * state->columns + entity->column);
+                bitboard_set(entity->type == ENTITY_BLOCK ? &bitboards->blocks : &bitboards->players, tile_index);
+        }
+}
+
+static inline void sync_tile(struct LevelBitboards *const bitboards, const struct LevelState *const state, const uint16_t tile_index) {
+        bitboard_reset(&bitboards->blocks, tile_index);
+        bitboard_reset(&bitboards->players, tile_index);
+
+        const uint16_t entity_index = state->occupants[tile_index];
+        if (entity_index != ENTITY_INDEX_NONE) {
+                bitboard_set(state->entities[entity_index].type == ENTITY_BLOCK ? &bitboards->blocks : &bitboards->players, tile_index);
+        }
+}
+
+void update_level_bitboards(struct LevelBitboards *const bitboards, const struct LevelState *const state, const struct Change *const change) {
+        switch (change->type) {
+                case CHANGE_WALK: case CHANGE_PUSH: case CHANGE_PUSHED: {
+                        // Syncing both tiles from the occupants, rather than moving the bit, keeps this correct no
+                        // matter in which order the changes of a push chain are applied
+                        sync_tile(bitboards, state, (uint16_t)(change->move.last_row * state->columns + change->move.last_column));
+                        sync_tile(bitboards, state, (uint16_t)(change->move.next_row * state->columns + change->move.next_column));
+                        break;
+                }
+
+                default: {
+                        break;
+                }
+        }
+}
+
+bool are_level_bitboards_won(const struct LevelBitboards *const bitboards) {
+        return bitboard_is_subset(&bitboards->spots, &bitboards->blocks);
+}
+
+void query_level_bitboards_movable(const struct LevelBitboards *const bitboards, const enum Orientation direction, struct Bitboard *const out_movable) {
+        const struct BitboardShifts *const shifts = &bitboards->shifts;
+        const enum Orientation backwards = orientation_reverse(direction);
+
+        struct Bitboard occupied;
+        bitboard_or(&bitboards->blocks, &bitboards->players, &occupied);
+
+        // An entity can move when the tile in front of it is floor it can stand on and that tile is either free or
+        // holds an entity that can move itself. Starting from nothing, every round adds one more link of the push chains
+        struct Bitboard movable = {0};
+        while (true) {
+                struct Bitboard vacant;
+                bitboard_and_not(&shifts->grid, &occupied, &vacant);
+                bitboard_or(&vacant, &movable, &vacant);
+
+                struct Bitboard player_targets, block_targets;
+                bitboard_and(&bitboards->player_floor, &vacant, &player_targets);
+                bitboard_and(&bitboards->block_floor, &vacant, &block_targets);
+
+                struct Bitboard movable_players, movable_blocks;
+                bitboard_shift(shifts, &player_targets, backwards, &movable_players);
+                bitboard_shift(shifts, &block_targets, backwards, &movable_blocks);
+                bitboard_and(&movable_players, &bitboards->players, &movable_players);
+                bitboard_and(&movable_blocks, &bitboards->blocks, &movable_blocks);
+
+                struct Bitboard next_movable;
+                bitboard_or(&movable_players, &movable_blocks, &next_movable);
+                if (bitboard_equals(&next_movable, &movable)) {
+                        break;
+                }
+
+                movable = next_movable;
+        }
+
+        *out_movable = movable;
+}
+
+void query_level_bitboards_reachable(const struct LevelBitboards *const bitboards, const uint16_t tile_index, struct Bitboard *const out_reachable) {
+        struct Bitboard start = {0};
+        bitboard_set(&start, tile_index);
+
+        struct Bitboard occupied, passable;
+        bitboard_or(&bitboards->blocks, &bitboards->players, &occupied);
+        bitboard_and_not(&bitboards->player_floor, &occupied, &passable);
+        bitboard_or(&passable, &start, &passable);
+
+        bitboard_flood(&bitboards->shifts, &start, &passable, out_reachable);
+}
+
+void query_level_bitboards_dead_tiles(const struct LevelBitboards *const bitboards, struct Bitboard *const out_dead_tiles, struct Bitboard *const out_joined_dead_tiles) {
+        const struct BitboardShifts *const shifts = &bitboards->shifts;
+
+        // Every round pulls the blocks on the live tiles one tile further away from the spots
+        struct Bitboard live;
+        bitboard_and(&bitboards->spots, &bitboards->block_floor, &live);
+
+        while (true) {
+                struct Bitboard grown = live;
+                for (int direction = 0; direction < ORIENTATION_COUNT; ++direction) {
+                        const enum Orientation backwards = orientation_reverse((enum Orientation)direction);
+
+                        // The tiles a push in this direction moves a block from, and the tiles with floor behind them
+                        struct Bitboard pulled, pushable;
+                        bitboard_shift(shifts, &live, backwards, &pulled);
+                        bitboard_shift(shifts, &bitboards->player_floor, (enum Orientation)direction, &pushable);
+
+                        bitboard_and(&pulled, &pushable, &pulled);
+                        bitboard_and(&pulled, &bitboards->block_floor, &pulled);
+                        bitboard_or(&grown, &pulled, &grown);
+                }
+
+                if (bitboard_equals(&grown, &live)) {
+                        break;
+                }
+
+                live = grown;
+        }
+
+        bitboard_and_not(&bitboards->block_floor, &live, out_dead_tiles);
+
+        struct Bitboard joined_live;
+        bitboard_flood(shifts, &bitboards->spots, &bitboards->block_floor, &joined_live);
+        bitboard_and_not(&bitboards->block_floor, &joined_live, out_joined_dead_tiles);
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "Defines.h"
+#include "Hexagons.h"
+#include "State.h"
+
+// Levels are capped at 'LEVEL_DIMENSION_LIMIT' squared tiles, so one bit per tile fits in a handful of
+// words and whole-level questions like "are all spots covered" turn into a few word operations
+
+#define BITBOARD_WORD_BITS 64
+
+#define BITBOARD_WORD_COUNT ((LEVEL_DIMENSION_LIMIT * LEVEL_DIMENSION_LIMIT + BITBOARD_WORD_BITS - 1) / BITBOARD_WORD_BITS)
+
+// Bits are laid out by tile index ('row * columns + column'), the same as the tiles of the level state
+struct Bitboard {
+        uint64_t words[BITBOARD_WORD_COUNT];
+};
+
+// The odd-q layout means that the tile index offset of a neighbor depends on whether the column is even
+// or odd, so every direction has one offset and one mask per column parity. The masks only keep the tiles
+// whose neighbor is inside the grid, which stops bits from wrapping around into the next row or column
+struct BitboardShifts {
+        uint8_t columns;
+        uint8_t rows;
+        struct Bitboard grid;
+        struct Bitboard masks[ORIENTATION_COUNT][2];
+        int16_t offsets[ORIENTATION_COUNT][2];
+};
+
+struct LevelBitboards {
+        struct BitboardShifts shifts;
+        struct Bitboard player_floor; // Tiles players can stand on (cells, spots and slabs)
+        struct Bitboard block_floor;  // Tiles blocks can stand on (cells and spots)
+        struct Bitboard slabs;
+        struct Bitboard spots;
+        struct Bitboard blocks;
+        struct Bitboard players;
+};
+
+static inline void bitboard_set(struct Bitboard *const bitboard, const uint16_t tile_index) {
+        bitboard->words[tile_index / BITBOARD_WORD_BITS] |= (uint64_t)1 << (tile_index % BITBOARD_WORD_BITS);
+}
+
+static inline void bitboard_reset(struct Bitboard *const bitboard, const uint16_t tile_index) {
+        bitboard->words[tile_index / BITBOARD_WORD_BITS] &= ~((uint64_t)1 << (tile_index % BITBOARD_WORD_BITS));
+}
+
+static inline bool bitboard_test(const struct Bitboard *const bitboard, const uint16_t tile_index) {
+        return (bitboard->words[tile_index / BITBOARD_WORD_BITS] >> (tile_index % BITBOARD_WORD_BITS)) & 1;
+}
+
+static inline void bitboard_and(const struct Bitboard *const a, const struct Bitboard *const b, struct Bitboard *const out) {
+        for (size_t index = 0ULL; index < BITBOARD_WORD_COUNT; ++index) {
+                out->words[index] = a->words[index] & b->words[index];
+        }
+}
+
+static inline void bitboard_or(const struct Bitboard *const a, const struct Bitboard *const b, struct Bitboard *const out) {
+        for (size_t index = 0ULL; index < BITBOARD_WORD_COUNT; ++index) {
+                out->words[index] = a->words[index] | b->words[index];
+        }
+}
+
+// Keeps the bits of 'a' that are not in 'b'
+static inline void bitboard_and_not(const struct Bitboard *const a, const struct Bitboard *const b, struct Bitboard *const out) {
+        for (size_t index = 0ULL; index < BITBOARD_WORD_COUNT; ++index) {
+                out->words[index] = a->words[index] & ~b->words[index];
+        }
+}
+
+static inline bool bitboard_equals(const struct Bitboard *const a, const struct Bitboard *const b) {
+        for (size_t index = 0ULL; index < BITBOARD_WORD_COUNT; ++index) {
+                if (a->words[index] != b->words[index]) {
+                        return false;
+                }
+        }
+
+        return true;
+}
+
+static inline bool bitboard_is_empty(const struct Bitboard *const bitboard) {
+        for (size_t index = 0ULL; index < BITBOARD_WORD_COUNT; ++index) {
+                if (bitboard->words[index] != 0) {
+                        return false;
+                }
+        }
+
+        return true;
+}
+
+// Whether every bit of 'a' is also in 'b'
+static inline bool bitboard_is_subset(const struct Bitboard *const a, const struct Bitboard *const b) {
+        for (size_t index = 0ULL; index < BITBOARD_WORD_COUNT; ++index) {
+                if (a->words[index] & ~b->words[index]) {
+                        return false;
+                }
+        }
+
+        return true;
+}
+
+static inline size_t bitboard_count(const struct Bitboard *const bitboard) {
+        size_t count = 0ULL;
+        for (size_t index = 0ULL; index < BITBOARD_WORD_COUNT; ++index) {
+#if defined(__GNUC__) || defined(__clang__)
+                count += (size_t)__builtin_popcountll(bitboard->words[index]);
+#else
+                for (uint64_t word = bitboard->words[index]; word != 0; word &= word - 1) {
+                        ++count;
+                }
+#endif
+        }
+
+        return count;
+}
+
+void initialize_bitboard_shifts(struct BitboardShifts *const shifts, const uint8_t columns, const uint8_t rows);
+
+// Moves every bit of the bitboard to its neighboring tile in the given direction, bits that would leave the grid are dropped
+void bitboard_shift(const struct BitboardShifts *const shifts, const struct Bitboard *const bitboard, const enum Orientation direction, struct Bitboard *const out);
+
+// Grows 'start' through the 'passable' tiles until it stops changing
+void bitboard_flood(const struct BitboardShifts *const shifts, const struct Bitboard *const start, const struct Bitboard *const passable, struct Bitboard *const out);
+
+void populate_level_bitboards(struct LevelBitboards *const bitboards, const struct LevelState *const state);
+
+// Has to be called after the change was applied to the level state, the bitboards are synced from its occupants
+void update_level_bitboards(struct LevelBitboards *const bitboards, const struct LevelState *const state, const struct Change *const change);
+
+bool are_level_bitboards_won(const struct LevelBitboards *const bitboards);
+
+// Finds every entity that would move if it tried to move in the given direction, including the entities at the
+// back of a push chain. The current player can move exactly when its tile is in the result. Joined blocks are
+// treated as loose blocks here, so for levels with joints 'apply_input' has the final say
+void query_level_bitboards_movable(const struct LevelBitboards *const bitboards, const enum Orientation direction, struct Bitboard *const out_movable);
+
+// Finds the block floor tiles that a block can never leave for a spot again. This works backwards from the spots by
+// pulling blocks: a block can get onto a tile if it can be pushed there from a neighboring block floor tile that has
+// floor behind it for whatever pushes it. Joined blocks can get dragged along by their group with nothing behind them,
+// so they get their own, smaller set of dead tiles
+void query_level_bitboards_dead_tiles(const struct LevelBitboards *const bitboards, struct Bitboard *const out_dead_tiles, struct Bitboard *const out_joined_dead_tiles);
+
+// Finds the tiles the player on the given tile can walk to without pushing anything
+void query_level_bitboards_reachable(const struct LevelBitboards *const bitboards, const uint16_t tile_index, struct Bitboard *const out_reachable);
\ No newline at end of file
@@ -9,14 +9,17 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
+#ifndef HEADLESS
 #include "SDL_timer.h"
 #include "SDL_platform.h"
 
 #include "Context.h"
 #include "Geometry.h"
 #include "Utilities.h"
-#include "Defines.h"
 #include "Text.h"
+#endif
+
+#include "Defines.h"
 
 void _assert_all_implementation(
         const char *const file,
@@ -71,12 +74,18 @@ void send_message(const enum MessageSeverity message_severity, const char *const
         va_list arguments;
         va_start(arguments, message);
 
+        // Measuring the message consumes the argument list, so the measurement gets a copy of it
+        va_list measured_arguments;
+        va_copy(measured_arguments, arguments);
+
 #if defined(__WIN32__)
-        const size_t size = (size_t)_vscprintf(message, arguments) + 1ULL;
+        const size_t size = (size_t)_vscprintf(message, measured_arguments) + 1ULL;
 #else
-        const size_t size = (size_t)vsnprintf(NULL, 0ULL, message, arguments) + 1ULL;
+        const size_t size = (size_t)vsnprintf(NULL, 0ULL, message, measured_arguments) + 1ULL;
 #endif
 
+        va_end(measured_arguments);
+
         char *const formatted_message = (char *)malloc(size);
         ASSERT_ALL(formatted_message != NULL); // This should be fine, debug messages only get sent on debug mode
 
@@ -137,7 +146,7 @@ bool get_process_memory_usage_bytes(size_t *const out_memory_usage_bytes) {
         return false;
 }
 
-#elif defined(__LINUX__)
+#elif defined(__LINUX__) || defined(__linux__)
 
 #include <stdio.h>
 #include <unistd.h>
@@ -174,6 +183,8 @@ bool get_process_memory_usage_bytes(size_t *) {
 
 #endif
 
+#ifndef HEADLESS
+
 #define REFRESH_MILLISECONDS 500
 static double actual_time_elapsed = 0.0;
 static double actual_time_accumulator = 0.0;
@@ -378,4 +389,6 @@ static void refresh_debug_panel(void) {
         resize_debug_panel();
 }
 
+#endif
+
 #endif
\ No newline at end of file
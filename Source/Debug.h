@@ -1,8 +1,11 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdbool.h>
 
+#ifndef HEADLESS
 #include "SDL_events.h"
+#endif
 
 enum MessageSeverity {
         MESSAGE_FATAL,
@@ -33,6 +36,8 @@ void _assert_all_implementation(
 
 void send_message(const enum MessageSeverity message_severity, const char *const message, ...);
 
+#ifndef HEADLESS
+
 void start_debug_frame_profiling(void);
 
 void finish_debug_frame_profiling(void);
@@ -45,12 +50,16 @@ bool debug_panel_receive_event(const SDL_Event *const event);
 
 void update_debug_panel(const double delta_time);
 
+#endif
+
 #else
 
 #define ASSERT_ALL(...) ((void)0)
 
 #define send_message(...) ((void)0)
 
+#ifndef HEADLESS
+
 void start_debug_frame_profiling(void) {
         return;
 }
@@ -75,4 +84,6 @@ void update_debug_panel(double) {
         return;
 }
 
+#endif
+
 #endif
\ No newline at end of file
@@ -86,6 +86,28 @@
 
 #define LEVEL_DATA_JOINT_STRIDE 3
 
+#define ENTITY_INDEX_NONE UINT16_MAX
+
+#define GROUP_INDEX_NONE UINT16_MAX
+
+// Steps beyond this depth get evicted from the undo history, oldest first
+#define STEP_HISTORY_MAXIMUM_DEPTH 65536
+
+// How many steps get re-simulated at most to seek in the step history or to undo in a compact one
+#define HISTORY_KEYFRAME_INTERVAL 64
+
+// How many of the latest steps the step history keeps a state hash of, has to be a power of two
+#define STEP_HISTORY_TRAIL_CAPACITY 4096
+
+// Inputs that arrive while the player is still animating wait in a queue of this size, anything beyond it is dropped
+#define INPUT_QUEUE_CAPACITY 8
+
+// Queued inputs that waited longer than this many milliseconds are dropped, 0 keeps them no matter how long they waited
+#define INPUT_QUEUE_LATENCY_BUDGET 1000
+
+// Once this many inputs are queued up, their animations are skipped so that the level keeps up with the inputs
+#define INPUT_QUEUE_TURBO_DEPTH 3
+
 // 100 MB of tracked memory
 #define SAFE_MEMORY_LIMIT_BYTES 1e8
 
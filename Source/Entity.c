@@ -18,10 +18,9 @@
 struct Entity {
         struct Level *level;
         enum EntityType type;
+        // Only the tiles the entity is animating between, the rules go by the entity table of the level state
         uint8_t last_column, last_row;
         uint8_t next_column, next_row;
-        enum Orientation last_orientation;
-        enum Orientation next_orientation;
         struct Animation recoiling;
         struct Animation moving;
         struct Animation turning;
@@ -88,8 +87,6 @@ struct Entity *create_entity(struct Level *const level, const enum EntityType ty
         entity->level = level;
         entity->last_column = entity->next_column = column;
         entity->last_row = entity->next_row = row;
-        entity->last_orientation = orientation;
-        entity->next_orientation = orientation;
         entity->angle = orientation_angle(orientation);
         entity->scale = 1.0f;
         entity->radius = 0.0f;
@@ -319,24 +316,54 @@ void resize_entity(struct Entity *const entity, const float radius) {
         query_level_tile(entity->level, entity->next_column, entity->next_row, NULL_X2, &entity->position.x, &entity->position.y);
 }
 
-void query_entity(
-        struct Entity *const entity,
-        enum EntityType *const out_type,
-        uint8_t *const out_column,
-        uint8_t *const out_row,
-        enum Orientation *const out_orientation,
-        float *const out_x,
-        float *const out_y
-) {
-        ASSERT_ALL(entity != NULL, out_type != NULL || out_column != NULL || out_row != NULL || out_orientation != NULL || out_x != NULL || out_y != NULL);
+void query_entity(struct Entity *const entity, enum EntityType *const out_type, float *const out_x, float *const out_y) {
+        ASSERT_ALL(entity != NULL, out_type != NULL || out_x != NULL || out_y != NULL);
         SAFE_ASSIGNMENT(out_type, entity->type);
-        SAFE_ASSIGNMENT(out_column, entity->next_column);
-        SAFE_ASSIGNMENT(out_row, entity->next_row);
-        SAFE_ASSIGNMENT(out_orientation, entity->next_orientation);
         SAFE_ASSIGNMENT(out_x, entity->position.x);
         SAFE_ASSIGNMENT(out_y, entity->position.y);
 }
 
+void place_entity(struct Entity *const entity, const uint8_t column, const uint8_t row, const enum Orientation orientation, const bool focused) {
+        stop_animation(&entity->moving);
+        stop_animation(&entity->turning);
+        stop_animation(&entity->scaling);
+        stop_animation(&entity->recoiling);
+
+        entity->last_column = entity->next_column = column;
+        entity->last_row = entity->next_row = row;
+        entity->angle = orientation_angle(orientation);
+        entity->scale = 1.0f;
+
+        query_level_tile(entity->level, column, row, NULL_X2, &entity->position.x, &entity->position.y);
+
+        if (entity->type == ENTITY_PLAYER) {
+                struct Player *const player = &entity->as.player;
+                stop_animation(&player->flapping);
+                stop_animation(&player->bouncing);
+                stop_animation(&player->focusing);
+
+                player->wings_angle = PLAYER_CLOSED_WINGS_ANGLE;
+                player->antenna_offset.x = 0.0f;
+                player->antenna_offset.y = 0.0f;
+                player->focused = focused;
+                player->focus = focused ? PLAYER_FOCUSED_SCALE : PLAYER_UNFOCUSED_SCALE;
+        }
+}
+
+void finish_entity_animations(struct Entity *const entity) {
+        finish_animation(&entity->moving);
+        finish_animation(&entity->turning);
+        finish_animation(&entity->scaling);
+        finish_animation(&entity->recoiling);
+
+        if (entity->type == ENTITY_PLAYER) {
+                struct Player *const player = &entity->as.player;
+                finish_animation(&player->flapping);
+                finish_animation(&player->bouncing);
+                finish_animation(&player->focusing);
+        }
+}
+
 bool entity_can_change(const struct Entity *const entity) {
         if (entity->moving.active || entity->turning.active || entity->recoiling.active) {
                 return false;
@@ -351,10 +378,13 @@ bool entity_can_change(const struct Entity *const entity) {
 
 void entity_handle_change(struct Entity *const entity, const struct Change *const change) {
         if (change->type == CHANGE_TURN) {
-                entity->last_orientation = change->turn.last_orientation;
-                entity->next_orientation = change->turn.next_orientation;
+                // A merged turn can span several orientations, so the angle comes from the orientations and not the input
+                int turns = ((int)change->turn.next_orientation - (int)change->turn.last_orientation + ORIENTATION_COUNT) % ORIENTATION_COUNT;
+                if (turns > ORIENTATION_COUNT / 2 || (turns == ORIENTATION_COUNT / 2 && change->input == INPUT_RIGHT)) {
+                        turns -= ORIENTATION_COUNT;
+                }
 
-                entity->turning.actions[0].keyframes.floats[1] = (change->input == INPUT_RIGHT ? -1.0f : 1.0f) * (float)M_PI * 2.0f / 6.0f;
+                entity->turning.actions[0].keyframes.floats[1] = (float)turns * (float)M_PI * 2.0f / (float)ORIENTATION_COUNT;
                 start_animation(&entity->turning, 0ULL);
                 PULSE_ENTITY_SCALE(entity, 1.1f);
 
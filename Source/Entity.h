@@ -4,12 +4,7 @@
 #include <stdbool.h>
 
 #include "Hexagons.h"
-
-enum EntityType {
-        ENTITY_PLAYER = 0,
-        ENTITY_BLOCK,
-        ENTITY_COUNT
-};
+#include "State.h"
 
 struct Level;
 struct Entity;
@@ -28,15 +23,14 @@ void update_entity(struct Entity *const entity, const double delta_time);
 
 void resize_entity(struct Entity *const entity, const float radius);
 
-void query_entity(
-        struct Entity *const entity,
-        enum EntityType *const out_type,
-        uint8_t *const out_column,
-        uint8_t *const out_row,
-        enum Orientation *const out_orientation,
-        float *const out_x,
-        float *const out_y
-);
+// Entities only present the level state, where an entity stands logically has to be asked from the level state
+void query_entity(struct Entity *const entity, enum EntityType *const out_type, float *const out_x, float *const out_y);
+
+// Puts the entity straight where it belongs without animating, for when the level jumps through its history
+void place_entity(struct Entity *const entity, const uint8_t column, const uint8_t row, const enum Orientation orientation, const bool focused);
+
+// Jumps every running animation of the entity to its end, so that it can take the next change right away
+void finish_entity_animations(struct Entity *const entity);
 
 struct Change;
 
@@ -13,6 +13,8 @@ enum Orientation {
         LOWER_RIGHT
 };
 
+#define ORIENTATION_COUNT 6
+
 static inline float orientation_angle(const enum Orientation orientation) {
         switch (orientation) {
                 case UPPER_RIGHT:  return (float)M_PI * 1.0f  / 6.0f;
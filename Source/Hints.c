@@ -0,0 +1,139 @@
+#include "Hints.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "Solver.h"
+#include "State.h"
+#include "Threads.h"
+#include "Memory.h"
+#include "Defines.h"
+#include "Debug.h"
+
+// Hints stay on a single thread so that the game keeps the rest of the processors, and the node limit keeps the
+// transposition table small enough to be allocated for every search
+#define HINT_THREAD_COUNT 1ULL
+#define HINT_NODE_LIMIT 262144ULL
+
+static void run_hint_engine(void *const data) {
+        struct HintEngine *const hint_engine = (struct HintEngine *)data;
+        struct EntityState *const entities = (struct EntityState *)xmalloc(MAXIMUM_VALUE((size_t)hint_engine->state.entity_count, 1ULL) * sizeof(struct EntityState));
+
+        lock_mutex(&hint_engine->mutex);
+        while (true) {
+                while (!hint_engine->requested && !hint_engine->quitting) {
+                        wait_condition(&hint_engine->condition, &hint_engine->mutex);
+                }
+
+                if (hint_engine->quitting) {
+                        break;
+                }
+
+                // Cancelling from here on stops the search, a cancel from before this request was dropped with it
+                const uint64_t generation = hint_engine->generation;
+                const uint16_t player_index = hint_engine->requested_player_index;
+                memcpy(entities, hint_engine->requested_entities, hint_engine->state.entity_count * sizeof(struct EntityState));
+                hint_engine->requested = false;
+                atomic_store(&hint_engine->cancelled, false);
+                unlock_mutex(&hint_engine->mutex);
+
+                restore_level_state(&hint_engine->state, entities, player_index);
+
+                struct SolverSolution solution;
+                struct SolverStatistics statistics;
+                const bool solved = solve_level_state(&hint_engine->state, HINT_THREAD_COUNT, HINT_NODE_LIMIT, &hint_engine->cache, &hint_engine->cancelled, &solution, &statistics);
+
+                lock_mutex(&hint_engine->mutex);
+                if (solved && solution.input_count > 0ULL && generation == hint_engine->generation) {
+                        hint_engine->answer = solution.inputs[0];
+                        hint_engine->answered = true;
+                }
+
+                deinitialize_solver_solution(&solution);
+        }
+
+        unlock_mutex(&hint_engine->mutex);
+        xfree(entities);
+}
+
+void initialize_hint_engine(struct HintEngine *const hint_engine, const struct LevelState *const state) {
+        *hint_engine = (struct HintEngine){0};
+        copy_level_state(state, &hint_engine->state);
+        initialize_solver_cache(&hint_engine->cache, state);
+        atomic_init(&hint_engine->cancelled, false);
+        initialize_mutex(&hint_engine->mutex);
+        initialize_condition(&hint_engine->condition);
+        hint_engine->requested_entities = (struct EntityState *)xmalloc(MAXIMUM_VALUE((size_t)state->entity_count, 1ULL) * sizeof(struct EntityState));
+        hint_engine->answer = INPUT_NONE;
+
+        hint_engine->running = start_thread(&hint_engine->thread, run_hint_engine, hint_engine);
+        if (!hint_engine->running) {
+                send_message(MESSAGE_WARNING, "Failed to start hint engine thread: Hints won't be available");
+        }
+}
+
+void deinitialize_hint_engine(struct HintEngine *const hint_engine) {
+        if (hint_engine->running) {
+                lock_mutex(&hint_engine->mutex);
+                hint_engine->quitting = true;
+                atomic_store(&hint_engine->cancelled, true);
+                signal_condition(&hint_engine->condition);
+                unlock_mutex(&hint_engine->mutex);
+
+                join_thread(&hint_engine->thread);
+        }
+
+        xfree(hint_engine->requested_entities);
+        deinitialize_condition(&hint_engine->condition);
+        deinitialize_mutex(&hint_engine->mutex);
+        deinitialize_solver_cache(&hint_engine->cache);
+        deinitialize_level_state(&hint_engine->state);
+        *hint_engine = (struct HintEngine){0};
+}
+
+void request_hint(struct HintEngine *const hint_engine, const struct LevelState *const state) {
+        if (!hint_engine->running) {
+                return;
+        }
+
+        lock_mutex(&hint_engine->mutex);
+        save_level_state(state, hint_engine->requested_entities, &hint_engine->requested_player_index);
+        hint_engine->requested = true;
+        hint_engine->answered = false;
+        ++hint_engine->generation;
+        atomic_store(&hint_engine->cancelled, true);
+        signal_condition(&hint_engine->condition);
+        unlock_mutex(&hint_engine->mutex);
+}
+
+void cancel_hint(struct HintEngine *const hint_engine) {
+        if (!hint_engine->running) {
+                return;
+        }
+
+        lock_mutex(&hint_engine->mutex);
+        hint_engine->requested = false;
+        hint_engine->answered = false;
+        ++hint_engine->generation;
+        atomic_store(&hint_engine->cancelled, true);
+        unlock_mutex(&hint_engine->mutex);
+}
+
+bool poll_hint(struct HintEngine *const hint_engine, enum Input *const out_input) {
+        // The thread only holds the mutex for a moment, if it does right now the hint can wait for the next frame
+        if (!hint_engine->running || !try_lock_mutex(&hint_engine->mutex)) {
+                return false;
+        }
+
+        const bool answered = hint_engine->answered;
+        if (answered) {
+                *out_input = hint_engine->answer;
+                hint_engine->answered = false;
+        }
+
+        unlock_mutex(&hint_engine->mutex);
+        return answered;
+}
\ No newline at end of file
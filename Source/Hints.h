@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "Solver.h"
+#include "State.h"
+#include "Threads.h"
+
+// Hints are searched for on a thread of their own so that the game never waits for the solver. Asking for a hint
+// hands the thread a copy of the entities, and the hint shows up in 'poll_hint' some frames later. Any change to the
+// level cancels the search that is going on, since its hint would be for a state that is gone already. The solver
+// cache is kept for as long as the level is, so following the hints or going back to a state that was hinted before
+// doesn't need another search
+
+struct HintEngine {
+        bool running;
+        struct Thread thread;
+        struct LevelState state;
+        struct SolverCache cache;
+        atomic_bool cancelled;
+
+        // Everything below is only touched with the mutex locked, and the thread never holds it while searching
+        struct Mutex mutex;
+        struct Condition condition;
+        bool quitting;
+        bool requested;
+        uint64_t generation;
+        struct EntityState *requested_entities;
+        uint16_t requested_player_index;
+        bool answered;
+        enum Input answer;
+};
+
+void initialize_hint_engine(struct HintEngine *const hint_engine, const struct LevelState *const state);
+
+void deinitialize_hint_engine(struct HintEngine *const hint_engine);
+
+// Starts searching for the next input from the given state, replacing any search that was going on
+void request_hint(struct HintEngine *const hint_engine, const struct LevelState *const state);
+
+void cancel_hint(struct HintEngine *const hint_engine);
+
+// Never waits, returns true once with the hint for the latest request and false until then. No hint ever comes for a
+// level that can't be won from the requested state
+bool poll_hint(struct HintEngine *const hint_engine, enum Input *const out_input);
\ No newline at end of file
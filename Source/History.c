@@ -0,0 +1,657 @@
+#include "History.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "State.h"
+#include "Memory.h"
+#include "Defines.h"
+#include "Debug.h"
+
+// All capacities are kept at powers of two so that wrapping around is just a mask
+#define STEP_HISTORY_INITIAL_CAPACITY (64ULL)
+#define STEP_HISTORY_INITIAL_KEYFRAME_CAPACITY (4ULL)
+
+// A record keeps the input in its lowest bits, then either the player that a switch switched to or the orientations
+// that a turn went from and to
+#define HISTORY_RECORD_INPUT_BITS (3)
+#define HISTORY_RECORD_INPUT_MASK ((1 << HISTORY_RECORD_INPUT_BITS) - 1)
+#define HISTORY_RECORD_ORIENTATION_BITS (3)
+#define HISTORY_RECORD_ORIENTATION_MASK ((1 << HISTORY_RECORD_ORIENTATION_BITS) - 1)
+
+_Static_assert(INPUT_NONE <= HISTORY_RECORD_INPUT_MASK, "Inputs don't fit in the history records");
+_Static_assert(ORIENTATION_COUNT <= HISTORY_RECORD_ORIENTATION_MASK + 1, "Orientations don't fit in the history records");
+_Static_assert((STEP_HISTORY_TRAIL_CAPACITY & (STEP_HISTORY_TRAIL_CAPACITY - 1)) == 0, "The trail capacity isn't a power of two");
+_Static_assert(LEVEL_DIMENSION_LIMIT * LEVEL_DIMENSION_LIMIT <= (UINT16_MAX >> HISTORY_RECORD_INPUT_BITS), "Entity indices don't fit in the history records");
+
+static inline size_t round_up_capacity(const size_t minimum_capacity) {
+        size_t capacity = 1ULL;
+        while (capacity < minimum_capacity) {
+                capacity *= 2ULL;
+        }
+
+        return capacity;
+}
+
+static inline size_t get_step_slot(const struct StepHistory *const step_history, const size_t position) {
+        return (step_history->step_head + position) & (step_history->step_capacity - 1ULL);
+}
+
+static inline size_t get_keyframe_slot(const struct StepHistory *const step_history, const size_t keyframe_index) {
+        return (step_history->keyframe_head + keyframe_index) & (step_history->keyframe_capacity - 1ULL);
+}
+
+static inline bool is_move_record(const uint16_t record) {
+        const enum Input input = (enum Input)(record & HISTORY_RECORD_INPUT_MASK);
+        return input == INPUT_FORWARD || input == INPUT_BACKWARD;
+}
+
+static inline bool is_turn_record(const uint16_t record) {
+        const enum Input input = (enum Input)(record & HISTORY_RECORD_INPUT_MASK);
+        return input == INPUT_LEFT || input == INPUT_RIGHT;
+}
+
+static inline enum Orientation get_record_last_orientation(const uint16_t record) {
+        return (enum Orientation)((record >> HISTORY_RECORD_INPUT_BITS) & HISTORY_RECORD_ORIENTATION_MASK);
+}
+
+static inline enum Orientation get_record_next_orientation(const uint16_t record) {
+        return (enum Orientation)((record >> (HISTORY_RECORD_INPUT_BITS + HISTORY_RECORD_ORIENTATION_BITS)) & HISTORY_RECORD_ORIENTATION_MASK);
+}
+
+static inline uint16_t create_record(const struct Change *const changes, const size_t change_count) {
+        const enum Input input = changes[0].input;
+
+        // Only the focused half of a switch carries the player that was switched to
+        if (input == INPUT_SWITCH && change_count > 1ULL) {
+                return (uint16_t)(input | changes[1].entity_index << HISTORY_RECORD_INPUT_BITS);
+        }
+
+        if (input == INPUT_LEFT || input == INPUT_RIGHT) {
+                return (uint16_t)(
+                        input |
+                        changes[0].turn.last_orientation << HISTORY_RECORD_INPUT_BITS |
+                        changes[0].turn.next_orientation << (HISTORY_RECORD_INPUT_BITS + HISTORY_RECORD_ORIENTATION_BITS)
+                );
+        }
+
+        return (uint16_t)input;
+}
+
+static inline enum InputResult replay_record(struct LevelState *const state, const uint16_t record, struct Change *const out_changes, size_t *const out_change_count) {
+        const enum Input input = (enum Input)(record & HISTORY_RECORD_INPUT_MASK);
+        if (input == INPUT_SWITCH) {
+                return apply_switch(state, (uint16_t)(record >> HISTORY_RECORD_INPUT_BITS), out_changes, out_change_count);
+        }
+
+        // A turn might stand for several merged turns, so it is replayed by its orientation rather than its input
+        if (input == INPUT_LEFT || input == INPUT_RIGHT) {
+                return apply_rotation(state, get_record_next_orientation(record), out_changes, out_change_count);
+        }
+
+        return apply_input(state, input, out_changes, out_change_count);
+}
+
+static void save_keyframe(struct StepHistory *const step_history, const struct LevelState *const state, const size_t keyframe_index) {
+        if (keyframe_index >= step_history->keyframe_capacity) {
+                const size_t keyframe_count = step_history->keyframe_capacity;
+                const size_t next_capacity = step_history->keyframe_capacity * 2ULL;
+                const size_t entity_count = (size_t)step_history->entity_count;
+
+                struct EntityState *const next_entities = (struct EntityState *)xmalloc(next_capacity * entity_count * sizeof(struct EntityState));
+                uint16_t *const next_player_indices = (uint16_t *)xmalloc(next_capacity * sizeof(uint16_t));
+                size_t *const next_move_counts = (size_t *)xmalloc(next_capacity * sizeof(size_t));
+
+                for (size_t index = 0ULL; index < keyframe_count; ++index) {
+                        const size_t slot = get_keyframe_slot(step_history, index);
+                        memcpy(&next_entities[index * entity_count], &step_history->keyframe_entities[slot * entity_count], entity_count * sizeof(struct EntityState));
+                        next_player_indices[index] = step_history->keyframe_player_indices[slot];
+                        next_move_counts[index] = step_history->keyframe_move_counts[slot];
+                }
+
+                xfree(step_history->keyframe_entities);
+                xfree(step_history->keyframe_player_indices);
+                xfree(step_history->keyframe_move_counts);
+
+                step_history->keyframe_entities = next_entities;
+                step_history->keyframe_player_indices = next_player_indices;
+                step_history->keyframe_move_counts = next_move_counts;
+                step_history->keyframe_capacity = next_capacity;
+                step_history->keyframe_head = 0ULL;
+        }
+
+        const size_t slot = get_keyframe_slot(step_history, keyframe_index);
+        save_level_state(state, &step_history->keyframe_entities[slot * step_history->entity_count], &step_history->keyframe_player_indices[slot]);
+        step_history->keyframe_move_counts[slot] = step_history->move_count;
+}
+
+static void restore_keyframe(struct StepHistory *const step_history, struct LevelState *const state, const size_t keyframe_index) {
+        const size_t slot = get_keyframe_slot(step_history, keyframe_index);
+        restore_level_state(state, &step_history->keyframe_entities[slot * step_history->entity_count], step_history->keyframe_player_indices[slot]);
+}
+
+// Growing unwraps the rings so that the oldest step and change end up at the start of the new buffers
+static void grow_steps(struct StepHistory *const step_history) {
+        const size_t length = get_step_history_length(step_history);
+        const size_t next_capacity = step_history->step_capacity * 2ULL;
+
+        uint16_t *const next_records = (uint16_t *)xmalloc(next_capacity * sizeof(uint16_t));
+        for (size_t position = 0ULL; position < length; ++position) {
+                next_records[position] = step_history->records[get_step_slot(step_history, position)];
+        }
+
+        xfree(step_history->records);
+        step_history->records = next_records;
+
+        if (!step_history->compact) {
+                struct HistoryStep *const next_steps = (struct HistoryStep *)xmalloc(next_capacity * sizeof(struct HistoryStep));
+                for (size_t position = 0ULL; position < length; ++position) {
+                        next_steps[position] = step_history->steps[get_step_slot(step_history, position)];
+                }
+
+                xfree(step_history->steps);
+                step_history->steps = next_steps;
+        }
+
+        step_history->step_capacity = next_capacity;
+        step_history->step_head = 0ULL;
+}
+
+static void grow_changes(struct StepHistory *const step_history, const size_t required_capacity) {
+        size_t next_capacity = step_history->change_capacity;
+        while (next_capacity < required_capacity) {
+                next_capacity *= 2ULL;
+        }
+
+        if (next_capacity == step_history->change_capacity) {
+                return;
+        }
+
+        const size_t mask = step_history->change_capacity - 1ULL;
+        struct Change *const next_changes = (struct Change *)xmalloc(next_capacity * sizeof(struct Change));
+
+        for (size_t index = 0ULL; index < step_history->change_count; ++index) {
+                next_changes[index] = step_history->changes[(step_history->change_head + index) & mask];
+        }
+
+        const size_t length = get_step_history_length(step_history);
+        for (size_t position = 0ULL; position < length; ++position) {
+                struct HistoryStep *const step = &step_history->steps[get_step_slot(step_history, position)];
+                step->change_start = (step->change_start - step_history->change_head) & mask;
+        }
+
+        xfree(step_history->changes);
+        step_history->changes = next_changes;
+        step_history->change_capacity = next_capacity;
+        step_history->change_head = 0ULL;
+}
+
+// Steps are evicted a whole keyframe interval at a time so that the oldest kept step always has a keyframe
+static void evict_oldest_steps(struct StepHistory *const step_history) {
+        if (!step_history->compact) {
+                size_t evicted_change_count = 0ULL;
+                for (size_t position = 0ULL; position < HISTORY_KEYFRAME_INTERVAL; ++position) {
+                        evicted_change_count += step_history->steps[get_step_slot(step_history, position)].change_count;
+                }
+
+                step_history->change_head = (step_history->change_head + evicted_change_count) & (step_history->change_capacity - 1ULL);
+                step_history->change_count -= evicted_change_count;
+        }
+
+        step_history->step_head = get_step_slot(step_history, HISTORY_KEYFRAME_INTERVAL);
+        step_history->step_count -= HISTORY_KEYFRAME_INTERVAL;
+        step_history->evicted_step_count += HISTORY_KEYFRAME_INTERVAL;
+        step_history->keyframe_head = get_keyframe_slot(step_history, 1ULL);
+}
+
+void initialize_step_history(struct StepHistory *const step_history, const struct LevelState *const state, const size_t maximum_depth, const uint8_t flags) {
+        ASSERT_ALL(maximum_depth > 0ULL);
+
+        *step_history = (struct StepHistory){0};
+        step_history->compact = (flags & STEP_HISTORY_FLAG_COMPACT) != 0;
+        step_history->maximum_depth = maximum_depth;
+
+        size_t step_capacity = STEP_HISTORY_INITIAL_CAPACITY;
+        size_t change_capacity = STEP_HISTORY_INITIAL_CAPACITY;
+        size_t keyframe_capacity = STEP_HISTORY_INITIAL_KEYFRAME_CAPACITY;
+
+        // Steps are evicted once there are a keyframe interval more of them than the maximum depth, so there are never
+        // more steps than that, every one of them with at most the change limit of changes, and a keyframe for every
+        // interval of them together with the one they start from
+        if (flags & STEP_HISTORY_FLAG_PREALLOCATE) {
+                step_capacity = round_up_capacity(maximum_depth + HISTORY_KEYFRAME_INTERVAL);
+                change_capacity = round_up_capacity((maximum_depth + HISTORY_KEYFRAME_INTERVAL) * get_level_state_change_limit(state));
+                keyframe_capacity = round_up_capacity(maximum_depth / HISTORY_KEYFRAME_INTERVAL + 2ULL);
+        }
+
+        step_history->records = (uint16_t *)xmalloc(step_capacity * sizeof(uint16_t));
+        step_history->step_capacity = step_capacity;
+
+        if (!step_history->compact) {
+                step_history->steps = (struct HistoryStep *)xmalloc(step_capacity * sizeof(struct HistoryStep));
+                step_history->changes = (struct Change *)xmalloc(change_capacity * sizeof(struct Change));
+                step_history->change_capacity = change_capacity;
+        }
+
+        step_history->entity_count = state->entity_count;
+        step_history->keyframe_capacity = keyframe_capacity;
+        step_history->keyframe_entities = (struct EntityState *)xmalloc(MAXIMUM_VALUE(keyframe_capacity * state->entity_count, 1ULL) * sizeof(struct EntityState));
+        step_history->keyframe_player_indices = (uint16_t *)xmalloc(keyframe_capacity * sizeof(uint16_t));
+        step_history->keyframe_move_counts = (size_t *)xmalloc(keyframe_capacity * sizeof(size_t));
+
+        if (flags & STEP_HISTORY_FLAG_TRAIL) {
+                step_history->trail = (struct HistoryTrailEntry *)xmalloc(STEP_HISTORY_TRAIL_CAPACITY * sizeof(struct HistoryTrailEntry));
+        }
+
+        save_keyframe(step_history, state, 0ULL);
+}
+
+void deinitialize_step_history(struct StepHistory *const step_history) {
+        if (step_history->records != NULL) {
+                xfree(step_history->records);
+        }
+
+        if (step_history->steps != NULL) {
+                xfree(step_history->steps);
+        }
+
+        if (step_history->changes != NULL) {
+                xfree(step_history->changes);
+        }
+
+        if (step_history->keyframe_entities != NULL) {
+                xfree(step_history->keyframe_entities);
+        }
+
+        if (step_history->keyframe_player_indices != NULL) {
+                xfree(step_history->keyframe_player_indices);
+        }
+
+        if (step_history->keyframe_move_counts != NULL) {
+                xfree(step_history->keyframe_move_counts);
+        }
+
+        if (step_history->trail != NULL) {
+                xfree(step_history->trail);
+        }
+
+        *step_history = (struct StepHistory){0};
+}
+
+void empty_step_history(struct StepHistory *const step_history, const struct LevelState *const state) {
+        step_history->step_head = 0ULL;
+        step_history->step_count = 0ULL;
+        step_history->redo_count = 0ULL;
+        step_history->change_head = 0ULL;
+        step_history->change_count = 0ULL;
+        step_history->keyframe_head = 0ULL;
+        step_history->move_count = 0ULL;
+        step_history->evicted_step_count = 0ULL;
+
+        save_keyframe(step_history, state, 0ULL);
+}
+
+void restart_step_history(
+        struct StepHistory *const step_history,
+        struct LevelState *const state,
+        const struct EntityState *const initial_entities,
+        const uint16_t initial_player_index,
+        uint16_t *const switch_anchor_player_index
+) {
+        restore_level_state(state, initial_entities, initial_player_index);
+        empty_step_history(step_history, state);
+        *switch_anchor_player_index = ENTITY_INDEX_NONE;
+}
+
+void step_history_push_step(struct StepHistory *const step_history, const struct LevelState *const state, const struct Change *const changes, const size_t change_count) {
+        if (change_count == 0ULL) {
+                return;
+        }
+
+        step_history_forget_undone(step_history);
+
+        if (step_history->step_count >= step_history->maximum_depth + HISTORY_KEYFRAME_INTERVAL) {
+                evict_oldest_steps(step_history);
+        }
+
+        if (step_history->step_count >= step_history->step_capacity) {
+                grow_steps(step_history);
+        }
+
+        const size_t slot = get_step_slot(step_history, step_history->step_count);
+
+        if (!step_history->compact) {
+                grow_changes(step_history, step_history->change_count + change_count);
+
+                const size_t mask = step_history->change_capacity - 1ULL;
+                const size_t change_start = (step_history->change_head + step_history->change_count) & mask;
+
+                for (size_t index = 0ULL; index < change_count; ++index) {
+                        step_history->changes[(change_start + index) & mask] = changes[index];
+                }
+
+                step_history->change_count += change_count;
+                step_history->steps[slot].change_start = change_start;
+                step_history->steps[slot].change_count = change_count;
+        }
+
+        const uint16_t record = create_record(changes, change_count);
+        step_history->records[slot] = record;
+        ++step_history->step_count;
+
+        if (is_move_record(record)) {
+                ++step_history->move_count;
+        }
+
+        if (step_history->step_count % HISTORY_KEYFRAME_INTERVAL == 0ULL) {
+                save_keyframe(step_history, state, step_history->step_count / HISTORY_KEYFRAME_INTERVAL);
+        }
+
+        // Switching straight to some player and switching through the players in between end up with the same step
+        // but not the same pushes, so switches are left to show up in the state hash of the next step instead
+        if (step_history->trail != NULL && (record & HISTORY_RECORD_INPUT_MASK) != INPUT_SWITCH) {
+                struct HistoryTrailEntry *const trail_entry = &step_history->trail[step_history->trail_count & (STEP_HISTORY_TRAIL_CAPACITY - 1ULL)];
+                trail_entry->state_hash = hash_level_state(state);
+                trail_entry->step_count = (uint32_t)step_history->step_count;
+                trail_entry->record = record;
+                ++step_history->trail_count;
+        }
+}
+
+bool step_history_pop_step(struct StepHistory *const step_history) {
+        step_history_forget_undone(step_history);
+
+        if (step_history->step_count == 0ULL) {
+                return false;
+        }
+
+        // A keyframe that was saved after this step gets overwritten once the step count reaches it again
+        const size_t slot = get_step_slot(step_history, step_history->step_count - 1ULL);
+
+        if (!step_history->compact) {
+                step_history->change_count -= step_history->steps[slot].change_count;
+        }
+
+        if (is_move_record(step_history->records[slot])) {
+                --step_history->move_count;
+        }
+
+        --step_history->step_count;
+        return true;
+}
+
+bool query_step_history_turn(const struct StepHistory *const step_history, enum Orientation *const out_last_orientation) {
+        if (step_history->step_count == 0ULL) {
+                return false;
+        }
+
+        const uint16_t record = step_history->records[get_step_slot(step_history, step_history->step_count - 1ULL)];
+        if (!is_turn_record(record)) {
+                return false;
+        }
+
+        SAFE_ASSIGNMENT(out_last_orientation, get_record_last_orientation(record));
+        return true;
+}
+
+void step_history_forget_undone(struct StepHistory *const step_history) {
+        if (!step_history->compact) {
+                const size_t length = get_step_history_length(step_history);
+                for (size_t position = step_history->step_count; position < length; ++position) {
+                        step_history->change_count -= step_history->steps[get_step_slot(step_history, position)].change_count;
+                }
+        }
+
+        step_history->redo_count = 0ULL;
+}
+
+// Pushes the changes with the first one swapped out, leaving the buffer as it was applied
+static inline void push_replaced_step(struct StepHistory *const step_history, const struct LevelState *const state, struct Change *const changes, const size_t change_count, const struct Change *const first_change) {
+        const struct Change applied_change = changes[0];
+        changes[0] = *first_change;
+        step_history_push_step(step_history, state, changes, change_count);
+        changes[0] = applied_change;
+}
+
+void step_history_play_input(
+        struct StepHistory *const step_history,
+        struct LevelState *const state,
+        uint16_t *const switch_anchor_player_index,
+        const enum Input input,
+        const uint16_t optional_player_index,
+        struct Change *const changes,
+        struct StepOutcome *const out_outcome
+) {
+        ASSERT_ALL(step_history != NULL, state != NULL, switch_anchor_player_index != NULL, changes != NULL, out_outcome != NULL);
+
+        out_outcome->result = INPUT_RESULT_NONE;
+        out_outcome->change_count = 0ULL;
+        out_outcome->changed = false;
+        out_outcome->ending_switches = input != INPUT_SWITCH && *switch_anchor_player_index != ENTITY_INDEX_NONE;
+        if (input != INPUT_SWITCH) {
+                *switch_anchor_player_index = ENTITY_INDEX_NONE;
+        }
+
+        switch (input) {
+                case INPUT_FORWARD: case INPUT_BACKWARD: {
+                        out_outcome->result = apply_input(state, input, changes, &out_outcome->change_count);
+                        if (out_outcome->result == INPUT_RESULT_BLOCKED || out_outcome->result == INPUT_RESULT_HIT) {
+                                return;
+                        }
+
+                        step_history_push_step(step_history, state, changes, out_outcome->change_count);
+                        out_outcome->changed = true;
+                        return;
+                }
+
+                case INPUT_LEFT: case INPUT_RIGHT: {
+                        out_outcome->result = apply_input(state, input, changes, &out_outcome->change_count);
+                        out_outcome->changed = true;
+
+                        // Turning all the way back leaves no step at all
+                        enum Orientation merged_orientation;
+                        if (!query_step_history_turn(step_history, &merged_orientation)) {
+                                step_history_push_step(step_history, state, changes, out_outcome->change_count);
+                                return;
+                        }
+
+                        step_history_pop_step(step_history);
+
+                        if (merged_orientation == changes[0].turn.next_orientation) {
+                                return;
+                        }
+
+                        struct Change merged_change = changes[0];
+                        merged_change.turn.last_orientation = merged_orientation;
+                        merged_change.input = get_turn_input(merged_orientation, merged_change.turn.next_orientation);
+                        push_replaced_step(step_history, state, changes, out_outcome->change_count, &merged_change);
+                        return;
+                }
+
+                case INPUT_UNDO: {
+                        out_outcome->changed = step_history_undo(step_history, state, changes, &out_outcome->change_count);
+                        return;
+                }
+
+                case INPUT_REDO: {
+                        out_outcome->changed = step_history_redo(step_history, state, changes, &out_outcome->change_count);
+                        return;
+                }
+
+                case INPUT_SWITCH: {
+                        if (state->player_count == 1) {
+                                return;
+                        }
+
+                        // If no player is given, the level state cycles through the entities to find the next player to switch to
+                        const uint16_t current_player_index = state->current_player_index;
+                        out_outcome->result = optional_player_index == ENTITY_INDEX_NONE
+                                ? apply_input(state, INPUT_SWITCH, changes, &out_outcome->change_count)
+                                : apply_switch(state, optional_player_index, changes, &out_outcome->change_count);
+
+                        if (out_outcome->result != INPUT_RESULT_SWITCHED) {
+                                return;
+                        }
+
+                        out_outcome->changed = true;
+
+                        if (*switch_anchor_player_index == ENTITY_INDEX_NONE) {
+                                step_history_push_step(step_history, state, changes, out_outcome->change_count);
+                                *switch_anchor_player_index = current_player_index;
+                                return;
+                        }
+
+                        // The previous switch either gets cancelled out by switching back to the anchor player or replaced with a switch from the anchor player to the next player
+                        step_history_pop_step(step_history);
+
+                        if (*switch_anchor_player_index == state->current_player_index) {
+                                *switch_anchor_player_index = ENTITY_INDEX_NONE;
+                                return;
+                        }
+
+                        struct Change anchored_change = changes[0];
+                        anchored_change.entity_index = *switch_anchor_player_index;
+                        push_replaced_step(step_history, state, changes, out_outcome->change_count, &anchored_change);
+                        return;
+                }
+
+                default: {
+                        return;
+                }
+        }
+}
+
+bool step_history_undo(struct StepHistory *const step_history, struct LevelState *const state, struct Change *const out_changes, size_t *const out_change_count) {
+        *out_change_count = 0ULL;
+
+        if (step_history->step_count == 0ULL) {
+                return false;
+        }
+
+        const size_t position = step_history->step_count - 1ULL;
+        const size_t slot = get_step_slot(step_history, position);
+
+        size_t change_count = 0ULL;
+        if (step_history->compact) {
+                // The undone step is replayed from the closest keyframe to find out its changes
+                const size_t keyframe_index = position / HISTORY_KEYFRAME_INTERVAL;
+                restore_keyframe(step_history, state, keyframe_index);
+
+                for (size_t replayed_position = keyframe_index * HISTORY_KEYFRAME_INTERVAL; replayed_position < position; ++replayed_position) {
+                        replay_record(state, step_history->records[get_step_slot(step_history, replayed_position)], out_changes, &change_count);
+                }
+
+                replay_record(state, step_history->records[slot], out_changes, &change_count);
+        } else {
+                const struct HistoryStep *const step = &step_history->steps[slot];
+                for (size_t index = 0ULL; index < step->change_count; ++index) {
+                        out_changes[index] = step_history->changes[(step->change_start + index) & (step_history->change_capacity - 1ULL)];
+                }
+
+                change_count = step->change_count;
+        }
+
+        for (size_t index = 0ULL; index < change_count; ++index) {
+                reverse_change(&out_changes[index], &out_changes[index]);
+                apply_change(state, &out_changes[index]);
+        }
+
+        if (is_move_record(step_history->records[slot])) {
+                --step_history->move_count;
+        }
+
+        *out_change_count = change_count;
+
+        --step_history->step_count;
+        ++step_history->redo_count;
+        return true;
+}
+
+bool step_history_redo(struct StepHistory *const step_history, struct LevelState *const state, struct Change *const out_changes, size_t *const out_change_count) {
+        *out_change_count = 0ULL;
+
+        if (step_history->redo_count == 0ULL) {
+                return false;
+        }
+
+        const size_t slot = get_step_slot(step_history, step_history->step_count);
+
+        if (step_history->compact) {
+                replay_record(state, step_history->records[slot], out_changes, out_change_count);
+        } else {
+                const struct HistoryStep *const step = &step_history->steps[slot];
+                for (size_t index = 0ULL; index < step->change_count; ++index) {
+                        out_changes[index] = step_history->changes[(step->change_start + index) & (step_history->change_capacity - 1ULL)];
+                        apply_change(state, &out_changes[index]);
+                }
+
+                *out_change_count = step->change_count;
+        }
+
+        if (is_move_record(step_history->records[slot])) {
+                ++step_history->move_count;
+        }
+
+        ++step_history->step_count;
+        --step_history->redo_count;
+        return true;
+}
+
+bool step_history_seek(struct StepHistory *const step_history, struct LevelState *const state, const size_t step_index, struct Change *const change_buffer) {
+        const size_t length = get_step_history_length(step_history);
+        if (step_index > length) {
+                return false;
+        }
+
+        const size_t keyframe_index = step_index / HISTORY_KEYFRAME_INTERVAL;
+        restore_keyframe(step_history, state, keyframe_index);
+        step_history->move_count = step_history->keyframe_move_counts[get_keyframe_slot(step_history, keyframe_index)];
+
+        for (size_t position = keyframe_index * HISTORY_KEYFRAME_INTERVAL; position < step_index; ++position) {
+                const uint16_t record = step_history->records[get_step_slot(step_history, position)];
+
+                size_t change_count;
+                replay_record(state, record, change_buffer, &change_count);
+
+                if (is_move_record(record)) {
+                        ++step_history->move_count;
+                }
+        }
+
+        step_history->step_count = step_index;
+        step_history->redo_count = length - step_index;
+        return true;
+}
+
+size_t get_step_history_memory_size(const struct StepHistory *const step_history) {
+        size_t size = step_history->step_capacity * sizeof(uint16_t);
+        if (!step_history->compact) {
+                size += step_history->step_capacity * sizeof(struct HistoryStep);
+                size += step_history->change_capacity * sizeof(struct Change);
+        }
+
+        size += step_history->keyframe_capacity * ((size_t)step_history->entity_count * sizeof(struct EntityState) + sizeof(uint16_t) + sizeof(size_t));
+        if (step_history->trail != NULL) {
+                size += STEP_HISTORY_TRAIL_CAPACITY * sizeof(struct HistoryTrailEntry);
+        }
+
+        return size;
+}
+
+void clear_step_history_trail(struct StepHistory *const step_history) {
+        step_history->trail_count = 0ULL;
+}
+
+void dump_step_history_trail(const struct StepHistory *const step_history, FILE *const file) {
+        if (step_history->trail == NULL) {
+                return;
+        }
+
+        const size_t first_entry_index = step_history->trail_count - MINIMUM_VALUE(step_history->trail_count, (size_t)STEP_HISTORY_TRAIL_CAPACITY);
+        for (size_t entry_index = first_entry_index; entry_index < step_history->trail_count; ++entry_index) {
+                const struct HistoryTrailEntry *const trail_entry = &step_history->trail[entry_index & (STEP_HISTORY_TRAIL_CAPACITY - 1ULL)];
+                fprintf(file, "%zu %u %04x %016llx\n", entry_index, (unsigned int)trail_entry->step_count, (unsigned int)trail_entry->record, (unsigned long long)trail_entry->state_hash);
+        }
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "State.h"
+
+// The step history is a timeline of steps with a cursor in it, the steps before the cursor are applied and the
+// ones after it were undone and can be redone. Every step keeps a record, the input packed together with the
+// player that a switch switched to, and every 'HISTORY_KEYFRAME_INTERVAL' steps a keyframe of the level state
+// is saved. Seeking restores the closest keyframe and replays the records from there.
+//
+// Unless the history is compact, the changes of every step are kept as well so that undoing and redoing can use
+// them directly. A compact history re-simulates the step from the closest keyframe instead, which trades a few
+// replayed steps on undo for a fraction of the memory.
+//
+// Everything lives in ring buffers, so pushing and popping steps never has to move the other steps around. Once
+// the maximum depth is reached a whole keyframe interval of the oldest steps is evicted to keep the memory flat.
+//
+// Apart from the timeline, a history with a trail has every pushed step other than a switch leave an entry with the
+// state hash in a trail that rolls over after 'STEP_HISTORY_TRAIL_CAPACITY' entries. The level and the replay verifier
+// push the same steps for the same inputs, so comparing their trails, or the trails of two builds, shows the first
+// step at which the rules stopped agreeing.
+
+// A preallocated history allocates everything it can ever need for its maximum depth up front, so pushing steps never
+// allocates. Otherwise the buffers start out small and grow as the steps come in
+enum StepHistoryFlag {
+        STEP_HISTORY_FLAG_COMPACT     = 1 << 0,
+        STEP_HISTORY_FLAG_PREALLOCATE = 1 << 1,
+        STEP_HISTORY_FLAG_TRAIL       = 1 << 2
+};
+
+struct HistoryStep {
+        size_t change_start;
+        size_t change_count;
+};
+
+struct HistoryTrailEntry {
+        uint64_t state_hash;
+        uint32_t step_count; // The steps that were applied right after this one was pushed
+        uint16_t record;
+};
+
+struct StepHistory {
+        bool compact;
+        size_t maximum_depth;
+
+        uint16_t *records;
+        struct HistoryStep *steps;
+        size_t step_capacity;
+        size_t step_head;
+        size_t step_count;
+        size_t redo_count;
+
+        struct Change *changes;
+        size_t change_capacity;
+        size_t change_head;
+        size_t change_count;
+
+        struct EntityState *keyframe_entities;
+        uint16_t *keyframe_player_indices;
+        size_t *keyframe_move_counts;
+        size_t keyframe_capacity;
+        size_t keyframe_head;
+        uint16_t entity_count;
+
+        size_t move_count;
+        size_t evicted_step_count; // Every step that was ever evicted, the kept steps come after this many
+
+        struct HistoryTrailEntry *trail; // NULL without a trail
+        size_t trail_count; // Every entry that was ever added, the ones before the capacity are overwritten
+};
+
+// The given level state becomes the first keyframe, so it should be the state the history starts from
+void initialize_step_history(struct StepHistory *const step_history, const struct LevelState *const state, const size_t maximum_depth, const uint8_t flags);
+
+void deinitialize_step_history(struct StepHistory *const step_history);
+
+// Forgets every step and starts over from the given level state
+void empty_step_history(struct StepHistory *const step_history, const struct LevelState *const state);
+
+// Puts the level state back to the given entities and forgets every step, which is how restarting works everywhere
+// the step rules are played. Any run of switches ends there as well
+void restart_step_history(
+        struct StepHistory *const step_history,
+        struct LevelState *const state,
+        const struct EntityState *const initial_entities,
+        const uint16_t initial_player_index,
+        uint16_t *const switch_anchor_player_index
+);
+
+// Has to be called after the step was applied to the level state, any undone steps are forgotten
+void step_history_push_step(struct StepHistory *const step_history, const struct LevelState *const state, const struct Change *const changes, const size_t change_count);
+
+// Forgets the latest step without touching the level state, used when a step gets replaced by another one
+bool step_history_pop_step(struct StepHistory *const step_history);
+
+// What playing an input through the step rules did, for whoever presents or records it
+struct StepOutcome {
+        enum InputResult result; // INPUT_RESULT_NONE for undoing and redoing
+        size_t change_count;     // Even a blocked move has changes, the ones that show it bumping into something
+        bool changed;            // Whether the level state changed
+        bool ending_switches;    // Any input but a switch ends a run of switches, even one without an effect
+};
+
+// The step rules that the level, the replay verifier and the batches all play their inputs with. Consecutive turns are
+// merged into one step, and so are consecutive switches, with '*switch_anchor_player_index' keeping the player that the
+// run of switches started from or ENTITY_INDEX_NONE outside of a run. A switch goes to the given player or to the next
+// one with ENTITY_INDEX_NONE. The changes are left in the buffer the way they were applied, even when the step that
+// got pushed was merged into another one, and the buffer has to be able to hold 'get_level_state_change_limit' changes
+void step_history_play_input(
+        struct StepHistory *const step_history,
+        struct LevelState *const state,
+        uint16_t *const switch_anchor_player_index,
+        const enum Input input,
+        const uint16_t optional_player_index,
+        struct Change *const changes,
+        struct StepOutcome *const out_outcome
+);
+
+// Tells whether the latest applied step is a turn and which orientation the turning player had before it, so that
+// consecutive turns can be merged into one step
+bool query_step_history_turn(const struct StepHistory *const step_history, enum Orientation *const out_last_orientation);
+
+void step_history_forget_undone(struct StepHistory *const step_history);
+
+// These leave the level state as it is after undoing, redoing or seeking. Undoing and redoing give back the changes
+// that got it there, the buffer has to be able to hold 'get_level_state_change_limit' changes either way
+bool step_history_undo(struct StepHistory *const step_history, struct LevelState *const state, struct Change *const out_changes, size_t *const out_change_count);
+
+bool step_history_redo(struct StepHistory *const step_history, struct LevelState *const state, struct Change *const out_changes, size_t *const out_change_count);
+
+// Moves the cursor so that 'step_index' of the kept steps are applied
+bool step_history_seek(struct StepHistory *const step_history, struct LevelState *const state, const size_t step_index, struct Change *const change_buffer);
+
+// Forgets the trail without touching the steps, a new trail is counted from zero again
+void clear_step_history_trail(struct StepHistory *const step_history);
+
+// Writes the kept trail entries oldest first, a line for each with its number, the step count, the record and the state
+// hash. Lines that are the same in two dumps come from the same steps, a history without a trail writes nothing
+void dump_step_history_trail(const struct StepHistory *const step_history, FILE *const file);
+
+// Every byte that the history has allocated, which only ever grows until the history is deinitialized
+size_t get_step_history_memory_size(const struct StepHistory *const step_history);
+
+static inline size_t get_step_history_length(const struct StepHistory *const step_history) {
+        return step_history->step_count + step_history->redo_count;
+}
\ No newline at end of file
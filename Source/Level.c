@@ -7,548 +7,458 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <sys/types.h>
+#include <time.h>
 
+#include "SDL_error.h"
+#include "SDL_filesystem.h"
 #include "SDL_render.h"
 #include "SDL_timer.h"
 
 #include "Audio.h"
-#include "cJSON.h"
-#include "Context.h"
 #include "Utilities.h"
 #include "Memory.h"
 #include "Entity.h"
+#include "State.h"
+#include "History.h"
+#include "Bitboard.h"
+#include "Pathfinding.h"
+#include "Hints.h"
+#include "Replay.h"
 #include "Geometry.h"
 #include "Defines.h"
 #include "Debug.h"
 
-#define STEP_HISTORY_INITIAL_CAPACITY (64ULL)
+#define TAP_TIME_THRESHOLD       (300)
+#define SWIPE_DISTANCE_THRESHOLD (0.15f)
+#define SWIPE_TIME_THRESHOLD     (500)
+#define TAP_DISTANCE_THRESHOLD   (0.05f)
 
-struct StepHistory {
-        struct Change *changes;
-        size_t change_capacity;
-        size_t change_count;
+#ifndef NDEBUG
+#define EVENT_IS_GESTURE_DOWN(event)   ((event)->type == SDL_FINGERDOWN   || (event)->type == SDL_MOUSEBUTTONDOWN)
+#define EVENT_IS_GESTURE_UP(event)     ((event)->type == SDL_FINGERUP     || (event)->type == SDL_MOUSEBUTTONUP)
+#define EVENT_IS_GESTURE_MOTION(event) ((event)->type == SDL_FINGERMOTION || (event)->type == SDL_MOUSEMOTION)
+#else
+#define EVENT_IS_GESTURE_DOWN(event)   ((event)->type == SDL_FINGERDOWN)
+#define EVENT_IS_GESTURE_UP(event)     ((event)->type == SDL_FINGERUP)
+#define EVENT_IS_GESTURE_MOTION(event) ((event)->type == SDL_FINGERMOTION)
+#endif
 
-        size_t *step_offsets;
-        size_t step_capacity;
-        size_t step_count;
+struct QueuedInput {
+        enum Input input;
+        uint16_t player_index;
+        uint32_t time;
 };
 
-static inline void initialize_step_history(struct StepHistory *const step_history) {
-        step_history->changes = (struct Change *)xmalloc(STEP_HISTORY_INITIAL_CAPACITY * sizeof(struct Change));
-        step_history->change_capacity = STEP_HISTORY_INITIAL_CAPACITY;
-        step_history->change_count = 0ULL;
+struct LevelImplementation {
+        struct LevelContext context;
+        char *title;
+        struct LevelState state;
+        struct Change *change_buffer;
+        struct Entity **entities;
+        uint16_t switch_anchor_player_index;
+        struct Geometry *joints_geometry;
+        struct GridMetrics grid_metrics;
+        struct Geometry *grid_geometry;
+        struct StepHistory step_history;
+        struct EntityState *initial_entities;
+        uint16_t initial_player_index;
+        struct Geometry *timeline_geometry;
+        float timeline_x;
+        float timeline_y;
+        float timeline_width;
+        bool scrubbing;
+        struct QueuedInput input_queue[INPUT_QUEUE_CAPACITY];
+        size_t input_queue_head;
+        size_t input_queue_count;
+        bool draining_input_queue;
+        struct PathFinder path_finder;
+        enum Input *path_inputs;
+        size_t path_input_count;
+        size_t path_input_index;
+        struct Bitboard dead_tiles;
+        struct Bitboard joined_dead_tiles;
+        struct Geometry *deadlock_geometry;
+        uint16_t block_count;
+        uint16_t dead_block_count;
+        struct HintEngine hint_engine;
+        enum Input hint_input;
+        size_t number;
+        struct Replay replay;
+        uint32_t replay_start_time;
+        uint32_t gesture_start_time;
+        float gesture_swipe_x;
+        float gesture_swipe_y;
+};
 
-        step_history->step_offsets = (size_t *)xmalloc(STEP_HISTORY_INITIAL_CAPACITY * sizeof(size_t));
-        step_history->step_capacity = STEP_HISTORY_INITIAL_CAPACITY;
-        step_history->step_count = 0ULL;
+static inline void level_play_sound(const struct Level *const level, const enum Sound sound) {
+        if (level->implementation->context.play_sound != NULL) {
+                level->implementation->context.play_sound(sound);
+        }
 }
 
-static inline void destroy_step_history(struct StepHistory *const step_history) {
-        xfree(step_history->changes);
-        step_history->changes = NULL;
-        step_history->change_capacity = 0ULL;
-        step_history->change_count = 0ULL;
+static inline void level_play_change_sound(const struct Level *const level, const struct Change *const change) {
+        switch (change->type) {
+                case CHANGE_WALK: {
+                        level_play_sound(level, SOUND_MOVE);
+                        break;
+                }
 
-        xfree(step_history->step_offsets);
-        step_history->step_offsets = NULL;
-        step_history->step_capacity = 0ULL;
-        step_history->step_count = 0ULL;
-}
+                case CHANGE_PUSH: {
+                        level_play_sound(level, SOUND_PUSH);
+                        break;
+                }
 
-static inline void empty_step_history(struct StepHistory *const step_history) {
-        step_history->change_count = 0ULL;
-        step_history->step_count = 0ULL;
-}
+                case CHANGE_TURN: {
+                        level_play_sound(level, SOUND_TURN);
+                        break;
+                }
 
-static inline void step_history_pop_step(struct StepHistory *const step_history, const size_t offset) {
-        if (offset >= step_history->step_count) {
-                return;
+                default: {
+                        break;
+                }
         }
+}
 
-        const size_t step_index = step_history->step_count - offset - 1ULL;
-        const size_t step_start = step_index == 0ULL ? 0ULL : step_history->step_offsets[step_index - 1ULL];
-        const size_t step_end   = step_history->step_offsets[step_index];
-        const size_t step_size  = step_end - step_start;
-
-        if (step_end < step_history->change_count) {
-                memmove(&step_history->changes[step_start],
-                        &step_history->changes[step_end],
-                        (step_history->change_count - step_end) * sizeof(struct Change));
-        }
+// Without presentation there is nothing to animate, so the current player can always take the next input
+static inline bool level_can_change(const struct Level *const level) {
+        const struct LevelImplementation *const implementation = level->implementation;
+        return !implementation->context.presenting || entity_can_change(implementation->entities[implementation->state.current_player_index]);
+}
 
-        step_history->change_count -= step_size;
+// Opposite turns always cancel out since consecutive turns are merged into one step anyway. Undoing and redoing don't,
+// since either of them might have nothing to undo or redo by the time it's processed and the other one would be lost
+static inline bool inputs_cancel_out(const enum Input first, const enum Input second) {
+        return (first == INPUT_LEFT && second == INPUT_RIGHT) || (first == INPUT_RIGHT && second == INPUT_LEFT);
+}
 
-        if (step_index + 1 < step_history->step_count) {
-                memmove(&step_history->step_offsets[step_index],
-                        &step_history->step_offsets[step_index + 1],
-                        (step_history->step_count - step_index - 1) * sizeof(size_t));
+// Inputs are queued while the current player is still animating or while older inputs are waiting, so that they are
+// processed in the order they came in
+static inline bool level_defer_input(struct Level *const level, const enum Input input, const uint16_t player_index) {
+        struct LevelImplementation *const implementation = level->implementation;
+        if (implementation->draining_input_queue) {
+                return false;
         }
 
-        for (size_t i = step_index; i < step_history->step_count - 1; ++i) {
-                step_history->step_offsets[i] -= step_size;
+        if (implementation->input_queue_count == 0ULL && level_can_change(level)) {
+                return false;
         }
 
-        --step_history->step_count;
-}
-
-// I am providing a callback function because the level might need to inspect the reverted changes to conditionally update it's state (not only the entities' states)
-static inline void step_history_swap_step(
-        struct StepHistory *const source,
-        struct StepHistory *const destination,
-        void (*change_reverted)(const struct Change *, struct StepHistory *, struct StepHistory *, void *),
-        void *const callback_data
-) {
-        if (source->step_count == 0ULL) {
-                return;
+        // An input that cancels out the latest queued one takes both of them out of the queue
+        if (implementation->input_queue_count > 0ULL) {
+                const size_t tail = (implementation->input_queue_head + implementation->input_queue_count - 1ULL) % INPUT_QUEUE_CAPACITY;
+                if (inputs_cancel_out(implementation->input_queue[tail].input, input)) {
+                        --implementation->input_queue_count;
+                        return true;
+                }
         }
 
-        const size_t step_end     = source->step_offsets[source->step_count - 1ULL];
-        const size_t step_start   = source->step_count > 1ULL ? source->step_offsets[source->step_count - 2ULL] : 0ULL;
-        const size_t step_changes = step_end - step_start;
-
-        for (size_t change_index = 0ULL; change_index < step_changes; ++change_index) {
-                const struct Change *change = &source->changes[step_start + change_index];
-
-                struct Change reversed = *change;
-
-                switch (change->type) {
-                        case CHANGE_WALK: case CHANGE_PUSH: case CHANGE_PUSHED: {
-                                if (change->type == CHANGE_WALK) {
-                                        play_sound(SOUND_MOVE);
-                                }
-
-                                if (change->type == CHANGE_PUSH) {
-                                        play_sound(SOUND_PUSH);
-                                }
-
-                                reversed.input = reversed.input == INPUT_FORWARD ? INPUT_BACKWARD : INPUT_FORWARD;
-
-                                SWAP_VALUES(uint16_t, reversed.move.last_column, reversed.move.next_column);
-                                SWAP_VALUES(uint16_t, reversed.move.last_row, reversed.move.next_row);
-                                break;
-                        }
+        if (implementation->input_queue_count == INPUT_QUEUE_CAPACITY) {
+                return true;
+        }
 
-                        case CHANGE_TURN: {
-                                play_sound(SOUND_TURN);
+        struct QueuedInput *const queued_input = &implementation->input_queue[(implementation->input_queue_head + implementation->input_queue_count) % INPUT_QUEUE_CAPACITY];
+        queued_input->input = input;
+        queued_input->player_index = player_index;
+        queued_input->time = (uint32_t)SDL_GetTicks();
+        ++implementation->input_queue_count;
+        return true;
+}
 
-                                reversed.input = reversed.input == INPUT_LEFT ? INPUT_RIGHT : INPUT_LEFT;
+static inline bool level_is_block_dead(const struct Level *const level, const uint16_t entity_index, const uint8_t column, const uint8_t row) {
+        const struct LevelState *const state = &level->implementation->state;
+        const struct Bitboard *const dead_tiles = state->group_indices[entity_index] == GROUP_INDEX_NONE
+                ? &level->implementation->dead_tiles
+                : &level->implementation->joined_dead_tiles;
 
-                                SWAP_VALUES(enum Orientation, reversed.turn.last_orientation, reversed.turn.next_orientation);
-                                break;
-                        }
+        return bitboard_test(dead_tiles, (uint16_t)(row * state->columns + column));
+}
 
-                        case CHANGE_TOGGLE: {
-                                reversed.toggle.focused = !reversed.toggle.focused;
-                                break;
-                        }
+static void level_count_dead_blocks(struct Level *const level) {
+        const struct LevelState *const state = &level->implementation->state;
 
-                        case CHANGE_BLOCKED: case CHANGE_INVALID: {
-                                continue;
-                        }
+        level->implementation->dead_block_count = 0;
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                const struct EntityState *const entity = &state->entities[entity_index];
+                if (entity->type == ENTITY_BLOCK && level_is_block_dead(level, entity_index, entity->column, entity->row)) {
+                        ++level->implementation->dead_block_count;
                 }
+        }
+}
 
-                entity_handle_change(reversed.entity, &reversed);
-                change_reverted(&reversed, source, destination, callback_data);
+// Only the blocks that moved in a step can have gone onto or off a dead tile, so checking a step takes no more than its changes
+static inline void level_track_dead_blocks(struct Level *const level, const struct Change *const changes, const size_t change_count) {
+        const struct LevelState *const state = &level->implementation->state;
 
-                if (destination->change_count >= destination->change_capacity) {
-                        destination->change_capacity *= 2ULL;
-                        destination->changes = (struct Change *)xrealloc(destination->changes, destination->change_capacity * sizeof(struct Change));
+        for (size_t change_index = 0ULL; change_index < change_count; ++change_index) {
+                const struct Change *const change = &changes[change_index];
+                if ((change->type != CHANGE_PUSH && change->type != CHANGE_PUSHED) || state->entities[change->entity_index].type != ENTITY_BLOCK) {
+                        continue;
                 }
 
-                destination->changes[destination->change_count++] = reversed;
-        }
+                if (level_is_block_dead(level, change->entity_index, change->move.last_column, change->move.last_row)) {
+                        --level->implementation->dead_block_count;
+                }
 
-        if (destination->step_count >= destination->step_capacity) {
-                destination->step_capacity *= 2ULL;
-                destination->step_offsets = (size_t *)xrealloc(destination->step_offsets, destination->step_capacity * sizeof(size_t));
+                if (level_is_block_dead(level, change->entity_index, change->move.next_column, change->move.next_row)) {
+                        ++level->implementation->dead_block_count;
+                }
         }
+}
 
-        destination->step_offsets[destination->step_count++] = destination->change_count;
-
-        source->change_count = step_start;
-        --source->step_count;
+// Blocks on dead tiles can never cover a spot again, so once too few blocks are left the level can't be won anymore
+static inline bool level_is_deadlocked(const struct Level *const level) {
+        const struct LevelImplementation *const implementation = level->implementation;
+        return implementation->block_count - implementation->dead_block_count < implementation->state.spot_count;
 }
 
-static inline struct Change *get_next_change_slot(struct StepHistory *const step_history) {
-        if (step_history->change_count >= step_history->change_capacity) {
-                step_history->change_capacity *= 2ULL;
-                step_history->changes = (struct Change *)xrealloc(step_history->changes, step_history->change_capacity * sizeof(struct Change));
+// A hint is only good for the state it was asked for, so every change to the level state drops it
+static inline void level_forget_hint(struct Level *const level) {
+        if (!level->implementation->context.hinting) {
+                return;
         }
 
-        return &step_history->changes[step_history->change_count++];
+        cancel_hint(&level->implementation->hint_engine);
+        level->implementation->hint_input = INPUT_NONE;
 }
 
-static inline void commit_pending_step(struct StepHistory *const step_history) {
-        const size_t last_offset = step_history->step_count ? step_history->step_offsets[step_history->step_count - 1ULL] : 0ULL;
-        const size_t step_changes = step_history->change_count - last_offset;
-        if (step_changes == 0ULL) {
+// Only inputs that changed the level get recorded, so that an input without an effect gives away a replay that diverged
+static inline void level_record_input(struct Level *const level, const enum Input input, const size_t repeat_count) {
+        struct LevelImplementation *const implementation = level->implementation;
+        if (!implementation->context.recording) {
                 return;
         }
 
-        if (step_history->step_count >= step_history->step_capacity) {
-                step_history->step_capacity *= 2ULL;
-                step_history->step_offsets = (size_t *)xrealloc(step_history->step_offsets, step_history->step_capacity * sizeof(size_t));
-        }
-
-        step_history->step_offsets[step_history->step_count++] = step_history->change_count;
-
-        for (size_t index = 0ULL; index < step_changes; ++index) {
-                struct Change *const change = &step_history->changes[step_history->change_count - 1ULL - index];
-                entity_handle_change(change->entity, change);
-        }
+        record_replay_input(&implementation->replay, input, repeat_count, (uint32_t)SDL_GetTicks() - implementation->replay_start_time, hash_level_state(&implementation->state));
 }
 
-static inline void discard_pending_step(struct StepHistory *const step_history, const enum Orientation direction) {
-        const size_t last_offset = step_history->step_count ? step_history->step_offsets[step_history->step_count - 1ULL] : 0ULL;
-        const size_t step_changes = step_history->change_count - last_offset;
-        if (step_changes == 0ULL) {
+static inline void level_present_changes(struct Level *const level, const struct Change *const changes, const size_t change_count) {
+        if (!level->implementation->context.presenting) {
                 return;
         }
 
-        for (size_t index = 0ULL; index < step_changes; ++index) {
-                struct Change *const change = &step_history->changes[step_history->change_count - 1ULL - index];
-                change->type = index == step_changes - 1ULL ? CHANGE_BLOCKED : CHANGE_INVALID;
-                change->face.direction = direction;
-
-                entity_handle_change(change->entity, change);
+        // The changes are presented back to front so that the front of a push chain starts moving first
+        for (size_t index = change_count; index-- > 0ULL;) {
+                entity_handle_change(level->implementation->entities[changes[index].entity_index], &changes[index]);
         }
-
-        step_history->change_count -= step_changes;
 }
 
-#undef STEP_HISTORY_INITIAL_CAPACITY
-
-#define TAP_TIME_THRESHOLD       (300)
-#define SWIPE_DISTANCE_THRESHOLD (0.15f)
-#define SWIPE_TIME_THRESHOLD     (500)
-#define TAP_DISTANCE_THRESHOLD   (0.05f)
-
-#ifndef NDEBUG
-#define EVENT_IS_GESTURE_DOWN(event)   ((event)->type == SDL_FINGERDOWN   || (event)->type == SDL_MOUSEBUTTONDOWN)
-#define EVENT_IS_GESTURE_UP(event)     ((event)->type == SDL_FINGERUP     || (event)->type == SDL_MOUSEBUTTONUP)
-#define EVENT_IS_GESTURE_MOTION(event) ((event)->type == SDL_FINGERMOTION || (event)->type == SDL_MOUSEMOTION)
-#else
-#define EVENT_IS_GESTURE_DOWN(event)   ((event)->type == SDL_FINGERDOWN)
-#define EVENT_IS_GESTURE_UP(event)     ((event)->type == SDL_FINGERUP)
-#define EVENT_IS_GESTURE_MOTION(event) ((event)->type == SDL_FINGERMOTION)
-#endif
-
-enum JointType {
-        JOINT_SOLID = 0,
-        JOINT_HONEY,
-        JOINT_COUNT
-};
+// Plays the input with the step rules that the replays and the batches use too, the callers present what it did
+static inline void level_play_input(struct Level *const level, const enum Input input, const uint16_t optional_player_index, struct StepOutcome *const out_outcome) {
+        struct LevelImplementation *const implementation = level->implementation;
+        step_history_play_input(&implementation->step_history, &implementation->state, &implementation->switch_anchor_player_index, input, optional_player_index, implementation->change_buffer, out_outcome);
 
-struct Joint {
-        enum JointType type;
-        struct Entity *block1;
-        struct Entity *block2;
-};
+        if (out_outcome->changed) {
+                level_forget_hint(level);
+        }
+}
 
-struct LevelImplementation {
-        char *title;
-        enum TileType *tiles;
-        uint16_t tile_count;
-        struct Entity **entities;
-        uint16_t entity_count;
-        uint16_t player_count;
-        uint16_t current_player_index;
-        struct Entity *switch_anchor_player;
-        uint16_t joint_count;
-        struct Joint *joints;
-        struct Geometry *joints_geometry;
-        struct GridMetrics grid_metrics;
-        struct Geometry *grid_geometry;
-        struct StepHistory step_history;
-        struct StepHistory undo_history;
-        bool has_buffered_input;
-        enum Input buffered_input;
-        void *buffered_input_data;
-        uint32_t gesture_start_time;
-        float gesture_swipe_x;
-        float gesture_swipe_y;
-};
+// An input without an effect is recorded anyway when it ends a run of switches, since the switches after it would
+// otherwise be merged into the run when the replay is played back
+static inline void level_record_ending_input(struct Level *const level, const enum Input input, const struct StepOutcome *const outcome) {
+        if (outcome->ending_switches) {
+                level_record_input(level, input, 1ULL);
+        }
+}
 
 static inline void level_process_move(struct Level *const level, const enum Input input) {
-        struct Entity *const current_player = level->implementation->entities[level->implementation->current_player_index];
-
-        if (!entity_can_change(current_player)) {
-                if (!level->implementation->has_buffered_input) {
-                        level->implementation->has_buffered_input = true;
-                        level->implementation->buffered_input = input;
-                }
-
+        if (level_defer_input(level, input, ENTITY_INDEX_NONE)) {
                 return;
         }
 
-        level->implementation->switch_anchor_player = NULL;
+        struct Change *const changes = level->implementation->change_buffer;
+        struct StepOutcome outcome;
+        level_play_input(level, input, ENTITY_INDEX_NONE, &outcome);
+        level_present_changes(level, changes, outcome.change_count);
 
-        uint8_t column, row;
-        enum Orientation direction;
-        query_entity(current_player, NULL, &column, &row, &direction, NULL_X2);
-        if (input == INPUT_BACKWARD) {
-                direction = orientation_reverse(direction);
-        }
+        if (!outcome.changed) {
+                level_record_ending_input(level, input, &outcome);
 
-        struct Entity *next_entity = current_player;
-        while (true) {
-                const bool first_change = next_entity == current_player;
-
-                struct Change *const change = get_next_change_slot(&level->implementation->step_history);
-                change->input = input;
-                change->type = first_change ? CHANGE_PUSH : CHANGE_PUSHED;
-                change->entity = next_entity;
-                change->move.last_column = column;
-                change->move.last_row = row;
-
-                size_t advanced_column, advanced_row;
-                if (!orientation_advance(direction, (size_t)column, (size_t)row, level->columns, level->rows, &advanced_column, &advanced_row)) {
-                        discard_pending_step(&level->implementation->step_history, direction);
-                        return;
+                if (outcome.result == INPUT_RESULT_HIT) {
+                        level_play_sound(level, SOUND_HIT);
                 }
 
-                change->move.next_column = column = (uint8_t)advanced_column;
-                change->move.next_row = row = (uint8_t)advanced_row;
-
-                enum TileType tile_type;
-                query_level_tile(level, column, row, &tile_type, &next_entity, NULL_X2);
-
-                if (tile_type == TILE_EMPTY) {
-                        discard_pending_step(&level->implementation->step_history, direction);
-                        play_sound(SOUND_HIT);
-                        return;
-                }
+                return;
+        }
 
-                // Players can walk on slab tiles but blocks can't get pushed onto them
-                if (tile_type == TILE_SLAB) {
-                        enum EntityType entity_type;
-                        query_entity(change->entity, &entity_type, NULL_X5);
+        level_record_input(level, input, 1ULL);
+        level_track_dead_blocks(level, changes, outcome.change_count);
+        ++level->move_count;
 
-                        if (entity_type == ENTITY_BLOCK) {
-                                discard_pending_step(&level->implementation->step_history, direction);
-                                play_sound(SOUND_HIT);
-                                return;
-                        }
+        if (outcome.result == INPUT_RESULT_WON) {
+                if (level->completion_callback != NULL) {
+                        level->completion_callback(level->completion_callback_data);
                 }
 
-                if (next_entity == NULL) {
-                        empty_step_history(&level->implementation->undo_history);
-                        ++level->move_count;
-
-                        if (first_change) {
-                                // This means that the next tile is valid but nothing will be pushed
-                                change->type = CHANGE_WALK;
-                                commit_pending_step(&level->implementation->step_history);
-                                play_sound(SOUND_MOVE);
-                                return;
-                        }
-
-                        commit_pending_step(&level->implementation->step_history);
-
-                        bool did_win = true;
-                        for (uint16_t tile_index = 0; tile_index < level->implementation->tile_count; ++tile_index) {
-                                const uint8_t tile_column = (uint8_t)(tile_index % level->columns);
-                                const uint8_t tile_row = (uint8_t)(tile_index / level->columns);
-
-                                enum TileType tile_type;
-                                struct Entity *entity;
-                                query_level_tile(level, tile_column, tile_row, &tile_type, &entity, NULL_X2);
-
-                                if (tile_type == TILE_SPOT) {
-                                        if (entity == NULL) {
-                                                did_win = false;
-                                                break;
-                                        }
-
-                                        enum EntityType entity_type;
-                                        query_entity(entity, &entity_type, NULL_X5);
-                                        if (entity_type != ENTITY_BLOCK) {
-                                                did_win = false;
-                                                break;
-                                        }
-                                }
-                        }
-
-                        if (did_win) {
-                                level->completion_callback(level->completion_callback_data);
-                                play_sound(SOUND_WIN);
-                                return;
-                        }
-
-                        play_sound(SOUND_PUSH);
-                        return;
-                }
+                level_play_sound(level, SOUND_WIN);
+                return;
         }
+
+        level_play_sound(level, outcome.result == INPUT_RESULT_WALKED ? SOUND_MOVE : SOUND_PUSH);
 }
 
 static inline void level_process_turn(struct Level *const level, const enum Input input) {
-        struct Entity *const current_player = level->implementation->entities[level->implementation->current_player_index];
-
-        if (!entity_can_change(current_player)) {
-                if (!level->implementation->has_buffered_input) {
-                        level->implementation->has_buffered_input = true;
-                        level->implementation->buffered_input = input;
-                }
-
+        if (level_defer_input(level, input, ENTITY_INDEX_NONE)) {
                 return;
         }
 
-        level->implementation->switch_anchor_player = NULL;
-
-        struct Change *const change = get_next_change_slot(&level->implementation->step_history);
-        change->input = input;
-        change->type = CHANGE_TURN;
-        change->entity = current_player;
-
-        query_entity(current_player, NULL_X3, &change->turn.last_orientation, NULL_X2);
-        change->turn.next_orientation = input == INPUT_RIGHT
-                ? orientation_turn_right(change->turn.last_orientation)
-                : orientation_turn_left(change->turn.last_orientation);
-
-        commit_pending_step(&level->implementation->step_history);
-        empty_step_history(&level->implementation->undo_history);
-        play_sound(SOUND_TURN);
+        struct StepOutcome outcome;
+        level_play_input(level, input, ENTITY_INDEX_NONE, &outcome);
+        level_present_changes(level, level->implementation->change_buffer, outcome.change_count);
+        level_record_input(level, input, 1ULL);
+        level_play_sound(level, SOUND_TURN);
 }
 
-static void change_reverted_callback(const struct Change *const change, struct StepHistory *, struct StepHistory *const destination, void *const callback_data) {
-        struct Level *const level = (struct Level *)callback_data;
-
-        if (change->type == CHANGE_TOGGLE) {
-                if (change->toggle.focused == true) {
-                        // Synchronize the current player index if a player switch was reverted
-                        for (uint16_t entity_index = 0; entity_index < level->implementation->entity_count; ++entity_index) {
-                                if (level->implementation->entities[entity_index] == change->entity) {
-                                        level->implementation->current_player_index = entity_index;
-                                        return;
-                                }
-                        }
+// The step history has already brought the level state up to date, so only the entities are left to catch up
+static inline void level_present_history_step(struct Level *const level, const struct Change *const changes, const size_t change_count) {
+        if (level->implementation->context.presenting) {
+                for (size_t change_index = 0ULL; change_index < change_count; ++change_index) {
+                        const struct Change *const change = &changes[change_index];
+                        level_play_change_sound(level, change);
+                        entity_handle_change(level->implementation->entities[change->entity_index], change);
                 }
-
-                return;
         }
 
-        if (change->type == CHANGE_WALK || change->type == CHANGE_PUSH) {
-                if (destination == &level->implementation->undo_history) {
-                        --level->move_count;
-                }
+        level->move_count = level->implementation->step_history.move_count;
+}
 
-                if (destination == &level->implementation->step_history) {
-                        ++level->move_count;
+// Jumping through the history skips the animations, every entity is put straight where the level state has it
+static void level_place_entities(struct Level *const level) {
+        const struct LevelState *const state = &level->implementation->state;
+        if (level->implementation->context.presenting) {
+                for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                        const struct EntityState *const entity = &state->entities[entity_index];
+                        place_entity(level->implementation->entities[entity_index], entity->column, entity->row, (enum Orientation)entity->orientation, entity_index == state->current_player_index);
                 }
-
-                return;
         }
+
+        level->move_count = level->implementation->step_history.move_count;
+        level->implementation->switch_anchor_player_index = ENTITY_INDEX_NONE;
+        level->implementation->input_queue_count = 0ULL;
+        level->implementation->path_input_count = 0ULL;
+        level_count_dead_blocks(level);
+        level_forget_hint(level);
 }
 
-static inline void level_process_undo(struct Level *const level) {
-        struct Entity *const current_player = level->implementation->entities[level->implementation->current_player_index];
+static inline void level_process_history_input(struct Level *const level, const enum Input input) {
+        if (level_defer_input(level, input, ENTITY_INDEX_NONE)) {
+                return;
+        }
 
-        if (!entity_can_change(current_player)) {
-                if (!level->implementation->has_buffered_input) {
-                        level->implementation->has_buffered_input = true;
-                        level->implementation->buffered_input = INPUT_UNDO;
-                }
+        struct StepOutcome outcome;
+        level_play_input(level, input, ENTITY_INDEX_NONE, &outcome);
 
+        if (!outcome.changed) {
+                level_record_ending_input(level, input, &outcome);
                 return;
         }
 
-        step_history_swap_step(&level->implementation->step_history, &level->implementation->undo_history, change_reverted_callback, (void *)level);
+        level_record_input(level, input, 1ULL);
+        level_track_dead_blocks(level, level->implementation->change_buffer, outcome.change_count);
+        level_present_history_step(level, level->implementation->change_buffer, outcome.change_count);
+}
+
+static inline void level_process_undo(struct Level *const level) {
+        level_process_history_input(level, INPUT_UNDO);
 }
 
 static inline void level_process_redo(struct Level *const level) {
-        struct Entity *const current_player = level->implementation->entities[level->implementation->current_player_index];
+        level_process_history_input(level, INPUT_REDO);
+}
 
-        if (!entity_can_change(current_player)) {
-                if (!level->implementation->has_buffered_input) {
-                        level->implementation->has_buffered_input = true;
-                        level->implementation->buffered_input = INPUT_REDO;
+// Replays only know switching to the next player, so switching straight to some player is recorded as the switches
+// that cycle through the players in between
+static inline size_t level_count_switch_inputs(const struct LevelState *const state, const uint16_t last_player_index, const uint16_t next_player_index) {
+        size_t switch_count = 0ULL;
+        for (uint16_t index = 1; index <= state->entity_count; ++index) {
+                const uint16_t entity_index = (last_player_index + index) % state->entity_count;
+                if (state->entities[entity_index].type == ENTITY_PLAYER) {
+                        ++switch_count;
                 }
 
-                return;
+                if (entity_index == next_player_index) {
+                        break;
+                }
         }
 
-        step_history_swap_step(&level->implementation->undo_history, &level->implementation->step_history, change_reverted_callback, (void *)level);
+        return switch_count;
 }
 
-static inline void level_process_switch(struct Level *const level, struct Entity *const optional_player) {
-        if (level->implementation->player_count == 1) {
+static inline void level_process_switch(struct Level *const level, const uint16_t optional_player_index) {
+        if (level->implementation->state.player_count == 1) {
                 return;
         }
 
-        struct Entity *const current_player = level->implementation->entities[level->implementation->current_player_index];
+        if (level_defer_input(level, INPUT_SWITCH, optional_player_index)) {
+                return;
+        }
 
-        if (!entity_can_change(current_player)) {
-                if (!level->implementation->has_buffered_input) {
-                        level->implementation->has_buffered_input = true;
-                        level->implementation->buffered_input = INPUT_SWITCH;
-                        level->implementation->buffered_input_data = (void *)optional_player;
-                }
+        const uint16_t current_player_index = level->implementation->state.current_player_index;
 
+        struct StepOutcome outcome;
+        level_play_input(level, INPUT_SWITCH, optional_player_index, &outcome);
+        if (!outcome.changed) {
                 return;
         }
 
-        struct Change *const current_player_change = get_next_change_slot(&level->implementation->step_history);
-        current_player_change->input = INPUT_SWITCH;
-        current_player_change->type = CHANGE_TOGGLE;
-        current_player_change->entity = current_player;
-        current_player_change->toggle.focused = false;
+        level_present_changes(level, level->implementation->change_buffer, outcome.change_count);
 
-        for (uint16_t index = 0; index < level->implementation->entity_count; ++index) {
-                if (optional_player != NULL) {
-                        if (level->implementation->entities[index] == optional_player) {
-                                level->implementation->current_player_index = index;
-                                break;
-                        }
-
-                        continue;
-                }
+        const uint16_t next_player_index = level->implementation->state.current_player_index;
+        level_record_input(level, INPUT_SWITCH, level_count_switch_inputs(&level->implementation->state, current_player_index, next_player_index));
+}
 
-                // If no player is given, cycle through entities to find the next player to switch to
-                enum EntityType entity_type;
-                const uint16_t entity_index = (level->implementation->current_player_index + index + 1) % level->implementation->entity_count;
-                query_entity(level->implementation->entities[entity_index], &entity_type, NULL_X5);
-                if (entity_type == ENTITY_PLAYER) {
-                        level->implementation->current_player_index = entity_index;
-                        break;
-                }
+// Replays and trails go next to the save file, named after the level and the time they were written
+static bool level_query_output_path(const struct Level *const level, const char *const extension, char *const out_path, const size_t path_size) {
+        char *const writable_directory_path = SDL_GetPrefPath("PlasmaPuffsProductions", "Sokobee");
+        if (!writable_directory_path) {
+                send_message(MESSAGE_ERROR, "Failed to query writable directory path: %s", SDL_GetError());
+                return false;
         }
 
-        struct Entity *const next_player = level->implementation->entities[level->implementation->current_player_index];
+        snprintf(out_path, path_size, "%sLevel%zu-%lld.%s", writable_directory_path, level->implementation->number, (long long)time(NULL), extension);
+        SDL_free(writable_directory_path);
+        return true;
+}
 
-        struct Change *const next_player_change = get_next_change_slot(&level->implementation->step_history);
-        next_player_change->input = INPUT_SWITCH;
-        next_player_change->type = CHANGE_TOGGLE;
-        next_player_change->entity = next_player;
-        next_player_change->toggle.focused = true;
+static void level_save_replay(const struct Level *const level) {
+#ifdef RECORD_REPLAYS
+        char replay_path_buffer[1024ULL];
+        if (!level_query_output_path(level, "sbr", replay_path_buffer, sizeof(replay_path_buffer))) {
+                send_message(MESSAGE_ERROR, "Failed to save replay: Failed to query replay path");
+                return;
+        }
 
-        commit_pending_step(&level->implementation->step_history);
-        empty_step_history(&level->implementation->undo_history);
+        if (write_replay(&level->implementation->replay, replay_path_buffer)) {
+                send_message(MESSAGE_INFORMATION, "Replay saved: \"%s\"", replay_path_buffer);
+        }
+#else
+        (void)level;
+#endif
+}
 
-        if (level->implementation->switch_anchor_player == NULL) {
-                level->implementation->switch_anchor_player = current_player;
+// The trail of the session can be compared against the one 'sokobee_replay --trail' plays back from its replay
+static void level_dump_trail(const struct Level *const level) {
+        char trail_path_buffer[1024ULL];
+        if (!level_query_output_path(level, "trail", trail_path_buffer, sizeof(trail_path_buffer))) {
+                send_message(MESSAGE_ERROR, "Failed to dump trail: Failed to query trail path");
                 return;
         }
 
-        if (level->implementation->switch_anchor_player == next_player) {
-                step_history_pop_step(&level->implementation->step_history, 0ULL);
-                step_history_pop_step(&level->implementation->step_history, 0ULL);
-                level->implementation->switch_anchor_player = NULL;
+        FILE *const file = fopen(trail_path_buffer, "w");
+        if (file == NULL) {
+                send_message(MESSAGE_ERROR, "Failed to dump trail to \"%s\"", trail_path_buffer);
                 return;
         }
 
-        current_player_change->entity = level->implementation->switch_anchor_player;
-
-        // Remove the penultimate step to essentially replace the last switch with this new one
-        step_history_pop_step(&level->implementation->step_history, 1ULL);
+        dump_step_history_trail(&level->implementation->step_history, file);
+        fclose(file);
+        send_message(MESSAGE_INFORMATION, "Trail dumped: \"%s\"", trail_path_buffer);
 }
 
-static bool parse_level(const cJSON *const json, struct Level *const level);
-
 static void resize_level(struct Level *const level);
 
-struct Level *load_level(const size_t number) {
+struct Level *load_level(const size_t number, const struct LevelContext *const context) {
         struct Level *const level = (struct Level *)xcalloc(1ULL, sizeof(struct Level));
-        if (!initialize_level(level, number)) {
+        if (!initialize_level(level, number, context)) {
                 send_message(MESSAGE_ERROR, "Failed to load level: Failed to initialize level");
                 destroy_level(level);
                 return NULL;
@@ -567,63 +477,92 @@ void destroy_level(struct Level *const level) {
         xfree(level);
 }
 
-bool initialize_level(struct Level *const level, const size_t number) {
+bool initialize_level(struct Level *const level, const size_t number, const struct LevelContext *const context) {
         level->columns = 0;
         level->rows = 0;
         level->move_count = 0ULL;
         level->completion_callback = NULL;
         level->completion_callback_data = NULL;
 
-        level->implementation = (struct LevelImplementation *)xmalloc(sizeof(struct LevelImplementation));
-        level->implementation->current_player_index = UINT16_MAX;
-        level->implementation->switch_anchor_player = NULL;
-        level->implementation->joint_count = 0;
-        level->implementation->joints = NULL;
-        level->implementation->joints_geometry = create_geometry();
-        level->implementation->grid_geometry = create_geometry();
+        level->implementation = (struct LevelImplementation *)xcalloc(1ULL, sizeof(struct LevelImplementation));
+        level->implementation->context = *context;
+        level->implementation->switch_anchor_player_index = ENTITY_INDEX_NONE;
+        level->implementation->hint_input = INPUT_NONE;
+        level->implementation->number = number;
         level->implementation->gesture_start_time = 0;
 
-        initialize_step_history(&level->implementation->step_history);
-        initialize_step_history(&level->implementation->undo_history);
-
         char level_path_buffer[32ULL];
         snprintf(level_path_buffer, sizeof(level_path_buffer), "Assets/Levels/Level%zu.json", number);
 
-        char *const json_string = load_text_file(level_path_buffer);
-        if (!json_string) {
-                send_message(MESSAGE_ERROR, "Failed to initialize level %zu: Failed to load level data file", level_path_buffer);
+        struct LevelState *const state = &level->implementation->state;
+        if (!initialize_level_state(state, level_path_buffer, &level->implementation->title)) {
+                send_message(MESSAGE_ERROR, "Failed to initialize level %zu: Failed to initialize level state", number);
                 deinitialize_level(level);
                 return false;
         }
 
-        cJSON *const json = cJSON_Parse(json_string);
-        xfree(json_string);
+        level->columns = state->columns;
+        level->rows = state->rows;
 
-        if (!json) {
-                send_message(MESSAGE_ERROR, "Failed to initialize level %zu: Failed to parse level data file: %s", level_path_buffer, cJSON_GetErrorPtr());
-                deinitialize_level(level);
-                return false;
+#ifdef COMPACT_STEP_HISTORY
+        initialize_step_history(&level->implementation->step_history, state, STEP_HISTORY_MAXIMUM_DEPTH, STEP_HISTORY_FLAG_COMPACT | STEP_HISTORY_FLAG_TRAIL);
+#else
+        initialize_step_history(&level->implementation->step_history, state, STEP_HISTORY_MAXIMUM_DEPTH, STEP_HISTORY_FLAG_TRAIL);
+#endif
+
+        // Restarting restores these instead of loading the level again
+        level->implementation->initial_entities = (struct EntityState *)xmalloc(state->entity_count * sizeof(struct EntityState));
+        save_level_state(state, level->implementation->initial_entities, &level->implementation->initial_player_index);
+
+        level->implementation->change_buffer = (struct Change *)xmalloc(get_level_state_change_limit(state) * sizeof(struct Change));
+
+        initialize_path_finder(&level->implementation->path_finder, state);
+        level->implementation->path_inputs = (enum Input *)xmalloc(get_path_finder_input_limit(&level->implementation->path_finder) * sizeof(enum Input));
+
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                if (state->entities[entity_index].type == ENTITY_BLOCK) {
+                        ++level->implementation->block_count;
+                }
         }
 
-        if (!parse_level(json, level)) {
-                send_message(MESSAGE_ERROR, "Failed to initialize level %zu: Failed to parse level from level data file", level_path_buffer);
-                deinitialize_level(level);
-                cJSON_Delete(json);
-                return NULL;
+        // The dead tiles only depend on the tiles, so they are worked out once and every step after that is checked against them
+        struct LevelBitboards bitboards;
+        populate_level_bitboards(&bitboards, state);
+        query_level_bitboards_dead_tiles(&bitboards, &level->implementation->dead_tiles, &level->implementation->joined_dead_tiles);
+        level_count_dead_blocks(level);
+
+        if (context->hinting) {
+                initialize_hint_engine(&level->implementation->hint_engine, state);
         }
 
-        cJSON_Delete(json);
+        initialize_replay(&level->implementation->replay, (uint16_t)number, state, true);
+        level->implementation->replay_start_time = (uint32_t)SDL_GetTicks();
 
         struct GridMetrics *const grid_metrics = &level->implementation->grid_metrics;
         grid_metrics->columns = (size_t)level->columns;
         grid_metrics->rows = (size_t)level->rows;
 
+        if (!context->presenting) {
+                return true;
+        }
+
+        level->implementation->joints_geometry = create_geometry();
+        level->implementation->grid_geometry = create_geometry();
+        level->implementation->timeline_geometry = create_geometry();
+        level->implementation->deadlock_geometry = create_geometry();
+        level->implementation->entities = (struct Entity **)xcalloc(state->entity_count, sizeof(struct Entity *));
+
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                const struct EntityState *const entity = &state->entities[entity_index];
+                level->implementation->entities[entity_index] = create_entity(level, (enum EntityType)entity->type, entity->column, entity->row, (enum Orientation)entity->orientation);
+        }
+
         struct Change selected_player_focus = {0};
         selected_player_focus.type = CHANGE_TOGGLE;
         selected_player_focus.toggle.focused = true;
         selected_player_focus.input = INPUT_SWITCH;
-        selected_player_focus.entity = level->implementation->entities[level->implementation->current_player_index];
-        entity_handle_change(selected_player_focus.entity, &selected_player_focus);
+        selected_player_focus.entity_index = state->current_player_index;
+        entity_handle_change(level->implementation->entities[selected_player_focus.entity_index], &selected_player_focus);
 
         resize_level(level);
         return true;
@@ -639,28 +578,46 @@ void deinitialize_level(struct Level *const level) {
                 return;
         }
 
-        destroy_step_history(&level->implementation->step_history);
-        destroy_step_history(&level->implementation->undo_history);
+        // Waits for the hint thread to stop, which is quick since quitting cancels the search
+        if (level->implementation->hint_engine.requested_entities) {
+                deinitialize_hint_engine(&level->implementation->hint_engine);
+        }
 
-        destroy_geometry(level->implementation->grid_geometry);
-        destroy_geometry(level->implementation->joints_geometry);
+        if (level->implementation->replay.code_count > 0ULL) {
+                level_save_replay(level);
+        }
+
+        deinitialize_replay(&level->implementation->replay);
+        deinitialize_step_history(&level->implementation->step_history);
+
+        if (level->implementation->path_inputs) {
+                xfree(level->implementation->path_inputs);
+                deinitialize_path_finder(&level->implementation->path_finder);
+        }
 
-        if (level->implementation->joints != NULL) {
-                xfree(level->implementation->joints);
+        if (level->implementation->initial_entities) {
+                xfree(level->implementation->initial_entities);
         }
 
         if (level->implementation->entities) {
-                for (uint16_t entity_index = 0; entity_index < level->implementation->entity_count; ++entity_index) {
+                destroy_geometry(level->implementation->deadlock_geometry);
+                destroy_geometry(level->implementation->timeline_geometry);
+                destroy_geometry(level->implementation->grid_geometry);
+                destroy_geometry(level->implementation->joints_geometry);
+
+                for (uint16_t entity_index = 0; entity_index < level->implementation->state.entity_count; ++entity_index) {
                         destroy_entity(level->implementation->entities[entity_index]);
                 }
 
                 xfree(level->implementation->entities);
         }
 
-        if (level->implementation->tiles) {
-                xfree(level->implementation->tiles);
+        if (level->implementation->change_buffer) {
+                xfree(level->implementation->change_buffer);
         }
 
+        deinitialize_level_state(&level->implementation->state);
+
         if (level->implementation->title) {
                 xfree(level->implementation->title);
         }
@@ -673,6 +630,68 @@ char *get_level_title(struct Level *const level) {
         return level->implementation->title;
 }
 
+uint64_t get_level_state_hash(const struct Level *const level) {
+        return hash_level_state(&level->implementation->state);
+}
+
+size_t get_level_par_move_count(const struct Level *const level) {
+        return (size_t)level->implementation->state.par_move_count;
+}
+
+void request_level_hint(struct Level *const level) {
+        if (!level->implementation->context.hinting) {
+                return;
+        }
+
+        level->implementation->hint_input = INPUT_NONE;
+        request_hint(&level->implementation->hint_engine, &level->implementation->state);
+}
+
+enum Input get_level_hint(const struct Level *const level) {
+        return level->implementation->hint_input;
+}
+
+void restart_level(struct Level *const level) {
+        struct LevelState *const state = &level->implementation->state;
+        restart_step_history(&level->implementation->step_history, state, level->implementation->initial_entities, level->implementation->initial_player_index, &level->implementation->switch_anchor_player_index);
+        level_place_entities(level);
+
+        if (level->implementation->context.recording) {
+                record_replay_restart(&level->implementation->replay, (uint32_t)SDL_GetTicks() - level->implementation->replay_start_time, hash_level_state(state));
+        }
+}
+
+bool seek_level(struct Level *const level, const size_t step_index) {
+        struct StepHistory *const step_history = &level->implementation->step_history;
+        const size_t clamped_step_index = MINIMUM_VALUE(step_index, get_step_history_length(step_history));
+        if (clamped_step_index == step_history->step_count) {
+                return false;
+        }
+
+        const size_t last_step_index = step_history->step_count;
+
+        if (!step_history_seek(step_history, &level->implementation->state, clamped_step_index, level->implementation->change_buffer)) {
+                send_message(MESSAGE_ERROR, "Failed to seek level to step %zu: Failed to seek step history", clamped_step_index);
+                return false;
+        }
+
+        // A jump ends up where undoing or redoing every step in between would
+        if (clamped_step_index < last_step_index) {
+                level_record_input(level, INPUT_UNDO, last_step_index - clamped_step_index);
+        } else {
+                level_record_input(level, INPUT_REDO, clamped_step_index - last_step_index);
+        }
+
+        level_place_entities(level);
+        return true;
+}
+
+void query_level_timeline(const struct Level *const level, size_t *const out_step_index, size_t *const out_step_count) {
+        ASSERT_ALL(level != NULL, out_step_index != NULL || out_step_count != NULL);
+        SAFE_ASSIGNMENT(out_step_index, level->implementation->step_history.step_count);
+        SAFE_ASSIGNMENT(out_step_count, get_step_history_length(&level->implementation->step_history));
+}
+
 bool query_level_tile(
         const struct Level *const level,
         const uint8_t column,
@@ -688,7 +707,9 @@ bool query_level_tile(
 
         ASSERT_ALL(level != NULL, out_tile_type != NULL || out_entity != NULL || out_x != NULL || out_y != NULL);
 
-        const enum TileType tile_type = level->implementation->tiles[row * level->columns + column];
+        enum TileType tile_type;
+        uint16_t entity_index;
+        query_level_state_tile(&level->implementation->state, column, row, &tile_type, out_entity != NULL ? &entity_index : NULL);
 
         float x, y;
         get_grid_tile_position(&level->implementation->grid_metrics, column, row, &x, &y);
@@ -698,17 +719,7 @@ bool query_level_tile(
         SAFE_ASSIGNMENT(out_y, tile_type == TILE_SLAB ? y - level->implementation->grid_metrics.tile_radius / 4.0f : y);
 
         if (out_entity != NULL) {
-                *out_entity = NULL;
-
-                for (uint16_t entity_index = 0; entity_index < level->implementation->entity_count; ++entity_index) {
-                        uint8_t entity_column, entity_row;
-                        struct Entity *const entity = level->implementation->entities[entity_index];
-                        query_entity(entity, NULL, &entity_column, &entity_row, NULL_X3);
-                        if (entity_column == column && entity_row == row) {
-                                *out_entity = entity;
-                                break;
-                        }
-                }
+                *out_entity = entity_index == ENTITY_INDEX_NONE || !level->implementation->context.presenting ? NULL : level->implementation->entities[entity_index];
         }
 
         return true;
@@ -729,6 +740,31 @@ static inline void get_event_position(const SDL_Event *const event, const int sc
         }
 }
 
+// A scrub has to start on the timeline but can then be dragged anywhere, the position is in drawable coordinates
+static bool level_scrub_timeline(struct Level *const level, const float x, const float y, const bool starting) {
+        struct LevelImplementation *const implementation = level->implementation;
+
+        const size_t step_count = get_step_history_length(&implementation->step_history);
+        if (step_count == 0ULL || implementation->timeline_width <= 0.0f) {
+                return false;
+        }
+
+        const float grab_distance = implementation->grid_metrics.tile_radius;
+        if (starting) {
+                if (fabsf(y - implementation->timeline_y) > grab_distance) {
+                        return false;
+                }
+
+                if (x < implementation->timeline_x - grab_distance || x > implementation->timeline_x + implementation->timeline_width + grab_distance) {
+                        return false;
+                }
+        }
+
+        const float progress = CLAMPED_VALUE((x - implementation->timeline_x) / implementation->timeline_width, 0.0f, 1.0f);
+        seek_level(level, (size_t)lroundf(progress * (float)step_count));
+        return true;
+}
+
 bool level_receive_event(struct Level *const level, const SDL_Event *const event) {
         if (event->type == SDL_WINDOWEVENT) {
                 const Uint8 window_event = event->window.event;
@@ -744,6 +780,9 @@ bool level_receive_event(struct Level *const level, const SDL_Event *const event
         if (event->type == SDL_KEYDOWN && event->key.repeat == 0) {
                 const SDL_Keycode key = event->key.keysym.sym;
 
+                // Any key takes over from a path that is still being walked
+                level->implementation->path_input_count = 0ULL;
+
                 if (key == SDLK_LEFT || key == SDLK_a) {
                         level_process_turn(level, INPUT_LEFT);
                         return true;
@@ -775,14 +814,53 @@ bool level_receive_event(struct Level *const level, const SDL_Event *const event
                 }
 
                 if (key == SDLK_LSHIFT || key == SDLK_RSHIFT) {
-                        // Pass 'NULL' to cycle through other players
-                        level_process_switch(level, NULL);
+                        // Pass 'ENTITY_INDEX_NONE' to cycle through other players
+                        level_process_switch(level, ENTITY_INDEX_NONE);
                         return true;
                 }
+
+                if (key == SDLK_HOME) {
+                        seek_level(level, 0ULL);
+                        return true;
+                }
+
+                if (key == SDLK_END) {
+                        seek_level(level, get_step_history_length(&level->implementation->step_history));
+                        return true;
+                }
+
+                if (key == SDLK_F9) {
+                        level_dump_trail(level);
+                        return true;
+                }
+        }
+
+        // Gestures are made on the level as it is drawn
+        if (!level->implementation->context.presenting) {
+                return false;
         }
 
         int screen_width, screen_height;
-        SDL_GetWindowSize(get_context_window(), &screen_width, &screen_height);
+        SDL_GetWindowSize(level->implementation->context.window, &screen_width, &screen_height);
+
+        if (EVENT_IS_GESTURE_DOWN(event) || (level->implementation->scrubbing && EVENT_IS_GESTURE_MOTION(event))) {
+                int drawable_width, drawable_height;
+                SDL_GetRendererOutputSize(level->implementation->context.renderer, &drawable_width, &drawable_height);
+
+                float scrub_x, scrub_y;
+                get_event_position(event, screen_width, screen_height, &scrub_x, &scrub_y);
+
+                if (level_scrub_timeline(level, scrub_x * (float)drawable_width, scrub_y * (float)drawable_height, !level->implementation->scrubbing)) {
+                        level->implementation->scrubbing = true;
+                        return true;
+                }
+        }
+
+        if (EVENT_IS_GESTURE_UP(event) && level->implementation->scrubbing) {
+                level->implementation->scrubbing = false;
+                level->implementation->gesture_start_time = 0;
+                return true;
+        }
 
         if (EVENT_IS_GESTURE_DOWN(event)) {
                 get_event_position(event, screen_width, screen_height, &level->implementation->gesture_swipe_x, &level->implementation->gesture_swipe_y);
@@ -791,42 +869,51 @@ bool level_receive_event(struct Level *const level, const SDL_Event *const event
         }
 
         if (EVENT_IS_GESTURE_UP(event) && level->implementation->gesture_start_time != 0) {
-                if (!level->implementation->has_buffered_input) {
-                        const uint32_t delta_time = (uint32_t)SDL_GetTicks() - level->implementation->gesture_start_time;
-
-                        float swiped_x, swiped_y;
-                        get_event_position(event, screen_width, screen_height, &swiped_x, &swiped_y);
-
-                        const float dx = swiped_x - level->implementation->gesture_swipe_x;
-                        const float dy = swiped_y - level->implementation->gesture_swipe_y;
-                        const float distance = sqrtf(dx * dx + dy * dy);
-
-                        if (distance < TAP_DISTANCE_THRESHOLD && delta_time < TAP_TIME_THRESHOLD) {
-                                int drawable_width, drawable_height;
-                                SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
-
-                                const float denormalized_x = swiped_x * (float)drawable_width;
-                                const float denormalized_y = swiped_y * (float)drawable_height;
-
-                                size_t tapped_column, tapped_row;
-                                if (get_grid_tile_at_position(&level->implementation->grid_metrics, denormalized_x, denormalized_y, &tapped_column, &tapped_row)) {
-                                        struct Entity *tapped_entity;
-                                        if (query_level_tile(level, (uint8_t)tapped_column, (uint8_t)tapped_row, NULL, &tapped_entity, NULL_X2) && tapped_entity != NULL) {
-                                                enum EntityType tapped_entity_type;
-                                                query_entity(tapped_entity, &tapped_entity_type, NULL_X5);
-                                                if (tapped_entity_type == ENTITY_PLAYER && tapped_entity != level->implementation->entities[level->implementation->current_player_index]) {
-                                                        level_process_switch(level, tapped_entity);
-                                                }
+                level->implementation->path_input_count = 0ULL;
+
+                const uint32_t delta_time = (uint32_t)SDL_GetTicks() - level->implementation->gesture_start_time;
+
+                float swiped_x, swiped_y;
+                get_event_position(event, screen_width, screen_height, &swiped_x, &swiped_y);
+
+                const float dx = swiped_x - level->implementation->gesture_swipe_x;
+                const float dy = swiped_y - level->implementation->gesture_swipe_y;
+                const float distance = sqrtf(dx * dx + dy * dy);
+
+                if (distance < TAP_DISTANCE_THRESHOLD && delta_time < TAP_TIME_THRESHOLD) {
+                        int drawable_width, drawable_height;
+                        SDL_GetRendererOutputSize(level->implementation->context.renderer, &drawable_width, &drawable_height);
+
+                        const float denormalized_x = swiped_x * (float)drawable_width;
+                        const float denormalized_y = swiped_y * (float)drawable_height;
+
+                        size_t tapped_column, tapped_row;
+                        if (get_grid_tile_at_position(&level->implementation->grid_metrics, denormalized_x, denormalized_y, &tapped_column, &tapped_row)) {
+                                const struct LevelState *const state = &level->implementation->state;
+
+                                enum TileType tapped_tile_type = TILE_EMPTY;
+                                uint16_t tapped_entity_index;
+                                if (query_level_state_tile(state, (uint8_t)tapped_column, (uint8_t)tapped_row, &tapped_tile_type, &tapped_entity_index) && tapped_entity_index != ENTITY_INDEX_NONE) {
+                                        if (state->entities[tapped_entity_index].type == ENTITY_PLAYER && tapped_entity_index != state->current_player_index) {
+                                                level_process_switch(level, tapped_entity_index);
+                                        }
+                                } else if (tapped_tile_type != TILE_EMPTY && level->implementation->input_queue_count == 0ULL) {
+                                        // Tapping a free tile walks the current player there, the path is fed to the input queue
+                                        // in 'update_level' one input at a time
+                                        size_t path_input_count;
+                                        if (find_level_state_path(&level->implementation->path_finder, state, (uint8_t)tapped_column, (uint8_t)tapped_row, level->implementation->path_inputs, &path_input_count)) {
+                                                level->implementation->path_input_count = path_input_count;
+                                                level->implementation->path_input_index = 0ULL;
                                         }
                                 }
                         }
+                }
 
-                        if (distance > SWIPE_DISTANCE_THRESHOLD && delta_time < SWIPE_TIME_THRESHOLD) {
-                                if (fabsf(dx) > fabsf(dy)) {
-                                        level_process_turn(level, dx > 0.0f ? INPUT_RIGHT : INPUT_LEFT);
-                                } else {
-                                        level_process_move(level, dy > 0.0f ? INPUT_BACKWARD : INPUT_FORWARD);
-                                }
+                if (distance > SWIPE_DISTANCE_THRESHOLD && delta_time < SWIPE_TIME_THRESHOLD) {
+                        if (fabsf(dx) > fabsf(dy)) {
+                                level_process_turn(level, dx > 0.0f ? INPUT_RIGHT : INPUT_LEFT);
+                        } else {
+                                level_process_move(level, dy > 0.0f ? INPUT_BACKWARD : INPUT_FORWARD);
                         }
                 }
 
@@ -837,43 +924,87 @@ bool level_receive_event(struct Level *const level, const SDL_Event *const event
         return false;
 }
 
+static void level_process_input(struct Level *const level, const enum Input input, const uint16_t optional_player_index) {
+        switch (input) {
+                case INPUT_BACKWARD: case INPUT_FORWARD: {
+                        level_process_move(level, input);
+                        break;
+                }
+
+                case INPUT_LEFT: case INPUT_RIGHT: {
+                        level_process_turn(level, input);
+                        break;
+                }
+
+                case INPUT_UNDO: {
+                        level_process_undo(level);
+                        break;
+                }
+
+                case INPUT_REDO: {
+                        level_process_redo(level);
+                        break;
+                }
+
+                case INPUT_SWITCH: {
+                        level_process_switch(level, optional_player_index);
+                        break;
+                }
+
+                default: {
+                        break;
+                }
+        }
+}
+
+void submit_level_input(struct Level *const level, const enum Input input) {
+        level->implementation->path_input_count = 0ULL;
+        level_process_input(level, input, ENTITY_INDEX_NONE);
+}
+
 void update_level(struct Level *const level, const double delta_time) {
-        struct Entity *const current_player = level->implementation->entities[level->implementation->current_player_index];
-        if (level->implementation->has_buffered_input && entity_can_change(current_player)) {
-                level->implementation->has_buffered_input = false;
+        struct LevelImplementation *const implementation = level->implementation;
 
-                switch (level->implementation->buffered_input) {
-                        case INPUT_BACKWARD: case INPUT_FORWARD: {
-                                level_process_move(level, level->implementation->buffered_input);
-                                break;
-                        }
+        enum Input hint_input;
+        if (poll_hint(&implementation->hint_engine, &hint_input)) {
+                implementation->hint_input = hint_input;
+        }
 
-                        case INPUT_LEFT: case INPUT_RIGHT: {
-                                level_process_turn(level, level->implementation->buffered_input);
-                                break;
-                        }
+        // Only one input of a path is queued at a time so that walking it never counts as inputs piling up
+        if (implementation->path_input_index < implementation->path_input_count && implementation->input_queue_count == 0ULL) {
+                struct QueuedInput *const queued_input = &implementation->input_queue[implementation->input_queue_head];
+                queued_input->input = implementation->path_inputs[implementation->path_input_index++];
+                queued_input->player_index = ENTITY_INDEX_NONE;
+                queued_input->time = (uint32_t)SDL_GetTicks();
+                implementation->input_queue_count = 1ULL;
+        }
 
-                        case INPUT_UNDO: {
-                                level_process_undo(level);
-                                break;
-                        }
+        while (implementation->input_queue_count > 0ULL && level_can_change(level)) {
+                const bool turbo = implementation->input_queue_count >= INPUT_QUEUE_TURBO_DEPTH;
 
-                        case INPUT_REDO: {
-                                level_process_redo(level);
-                                break;
-                        }
+                const struct QueuedInput queued_input = implementation->input_queue[implementation->input_queue_head];
+                implementation->input_queue_head = (implementation->input_queue_head + 1ULL) % INPUT_QUEUE_CAPACITY;
+                --implementation->input_queue_count;
 
-                        case INPUT_SWITCH: {
-                                level_process_switch(level, (struct Entity *)level->implementation->buffered_input_data);
-                                break;
-                        }
+                if (INPUT_QUEUE_LATENCY_BUDGET > 0 && (uint32_t)SDL_GetTicks() - queued_input.time > INPUT_QUEUE_LATENCY_BUDGET) {
+                        continue;
+                }
 
-                        default: {
-                                break;
+                implementation->draining_input_queue = true;
+                level_process_input(level, queued_input.input, queued_input.player_index);
+                implementation->draining_input_queue = false;
+
+                if (turbo && implementation->context.presenting) {
+                        for (uint16_t entity_index = 0; entity_index < implementation->state.entity_count; ++entity_index) {
+                                finish_entity_animations(implementation->entities[entity_index]);
                         }
                 }
         }
 
+        if (!implementation->context.presenting) {
+                return;
+        }
+
         render_geometry(level->implementation->grid_geometry);
 
         clear_geometry(level->implementation->joints_geometry);
@@ -883,12 +1014,12 @@ void update_level(struct Level *const level, const double delta_time) {
         const float block_offset = tile_radius / -10.0f;
         const float line_shrink = line_width * 1.5f;
 
-        for (uint16_t joint_index = 0; joint_index < level->implementation->joint_count; ++joint_index) {
-                struct Joint *const joint = &level->implementation->joints[joint_index];
+        for (uint16_t joint_index = 0; joint_index < level->implementation->state.joint_count; ++joint_index) {
+                const struct Joint *const joint = &level->implementation->state.joints[joint_index];
 
                 float x1, y1, x2, y2;
-                query_entity(joint->block1, NULL_X4, &x1, &y1);
-                query_entity(joint->block2, NULL_X4, &x2, &y2);
+                query_entity(level->implementation->entities[joint->block1_index], NULL, &x1, &y1);
+                query_entity(level->implementation->entities[joint->block2_index], NULL, &x2, &y2);
 
                 y1 += block_offset;
                 y2 += block_offset;
@@ -928,175 +1059,63 @@ void update_level(struct Level *const level, const double delta_time) {
 
         render_geometry(level->implementation->joints_geometry);
 
-        for (uint16_t entity_index = 0; entity_index < level->implementation->entity_count; ++entity_index) {
-                update_entity(level->implementation->entities[entity_index], delta_time);
-        }
-}
-
-static bool parse_level(const cJSON *const json, struct Level *const level) {
-        if (!cJSON_IsObject(json)) {
-                send_message(MESSAGE_ERROR, "Failed to parse level: JSON data is invalid");
-                return false;
-        }
+        // The blocks that can't reach a spot anymore get marked for as long as the level can't be won
+        if (level_is_deadlocked(level)) {
+                struct Geometry *const deadlock_geometry = level->implementation->deadlock_geometry;
+                clear_geometry(deadlock_geometry);
+                set_geometry_color(deadlock_geometry, COLOR_HONEY, COLOR_OPAQUE);
 
-        const cJSON *const title_json    = cJSON_GetObjectItemCaseSensitive(json, "title");
-        const cJSON *const columns_json  = cJSON_GetObjectItemCaseSensitive(json, "columns");
-        const cJSON *const rows_json     = cJSON_GetObjectItemCaseSensitive(json, "rows");
-        const cJSON *const tiles_json    = cJSON_GetObjectItemCaseSensitive(json, "tiles");
-        const cJSON *const entities_json = cJSON_GetObjectItemCaseSensitive(json, "entities");
-        const cJSON *const joints_json   = cJSON_GetObjectItemCaseSensitive(json, "joints");
-
-        if (
-                !cJSON_IsString(title_json)   ||
-                !cJSON_IsNumber(columns_json) ||
-                !cJSON_IsNumber(rows_json)    ||
-                !cJSON_IsArray(tiles_json)    ||
-                !cJSON_IsArray(entities_json) ||
-                !cJSON_IsArray(joints_json)
-        ) {
-                send_message(MESSAGE_ERROR, "Failed to parse level: JSON data is invalid");
-                return false;
-        }
-
-        level->implementation->title = xstrdup(title_json->valuestring);
-
-        const double columns = columns_json->valuedouble;
-        if (floor(columns) != columns || columns <= 0.0 || columns > (double)LEVEL_DIMENSION_LIMIT) {
-                send_message(MESSAGE_ERROR, "Failed to parse level: The grid columns %lf is invalid, it should be an integer between 0 and %u", columns, LEVEL_DIMENSION_LIMIT);
-                return false;
-        }
-
-        const double rows = rows_json->valuedouble;
-        if (floor(rows) != rows || rows <= 0.0 || rows > (double)LEVEL_DIMENSION_LIMIT) {
-                send_message(MESSAGE_ERROR, "Failed to parse level: The grid rows %lf is invalid, it should be an integer between 0 and %u", rows, LEVEL_DIMENSION_LIMIT);
-                return false;
-        }
-
-        level->columns = (uint8_t)columns;
-        level->rows = (uint8_t)rows;
-
-        const size_t tile_count = (size_t)cJSON_GetArraySize(tiles_json);
-        level->implementation->tile_count = (size_t)level->columns * (size_t)level->rows;
-        if (tile_count != level->implementation->tile_count) {
-                send_message(MESSAGE_ERROR, "Failed to parse level: The tile count of %zu does not match the expected tile count of %zu (%u * %u)", tile_count, level->implementation->tile_count, level->columns, level->rows);
-                return false;
-        }
-
-        level->implementation->tiles = (enum TileType *)xmalloc(level->implementation->tile_count * sizeof(enum TileType));
-
-        size_t tile_index = 0ULL;
-        const cJSON *tile_json = NULL;
-        cJSON_ArrayForEach(tile_json, tiles_json) {
-                if (!cJSON_IsNumber(tile_json)) {
-                        send_message(MESSAGE_ERROR, "Failed to parse level: JSON data is invalid");
-                        return false;
-                }
+                const struct LevelState *const state = &level->implementation->state;
+                for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                        const struct EntityState *const entity = &state->entities[entity_index];
+                        if (entity->type != ENTITY_BLOCK || !level_is_block_dead(level, entity_index, entity->column, entity->row)) {
+                                continue;
+                        }
 
-                const double tile = tile_json->valuedouble;
-                if (floor(tile) != tile || tile < 0.0 || (size_t)tile > (size_t)TILE_COUNT) {
-                        send_message(MESSAGE_ERROR, "Failed to parse level: The tile #%zu of %lf is invalid, it should be an integer between 0 and %d", tile_index, tile, (int)TILE_COUNT);
-                        return false;
+                        float x, y;
+                        get_grid_tile_position(&level->implementation->grid_metrics, entity->column, entity->row, &x, &y);
+                        write_hexagon_geometry(deadlock_geometry, x, y, tile_radius, 0.0f);
                 }
 
-                level->implementation->tiles[tile_index++] = (enum TileType)(uint8_t)tile;
-        }
-
-        const int entities_length = cJSON_GetArraySize(entities_json);
-        if (entities_length % LEVEL_DATA_ENTITY_STRIDE != 0) {
-                send_message(MESSAGE_ERROR, "Failed to parse level: Entities array length of %d is not a multiple of %d", entities_length, LEVEL_DATA_ENTITY_STRIDE);
-                return false;
+                render_geometry(deadlock_geometry);
         }
 
-        level->implementation->entity_count = (uint16_t)(entities_length / LEVEL_DATA_ENTITY_STRIDE);
-        level->implementation->entities = (struct Entity **)xcalloc(level->implementation->entity_count, sizeof(struct Entity *));
-
-        const cJSON *entity_part_json = entities_json->child;
-        for (uint16_t entity_index = 0; entity_index < level->implementation->entity_count; ++entity_index) {
-                const cJSON *const entity_type_json        = entity_part_json;
-                const cJSON *const entity_column_json      = entity_type_json->next;
-                const cJSON *const entity_row_json         = entity_column_json->next;
-                const cJSON *const entity_orientation_json = entity_row_json->next;
-                const cJSON *const entity_data_json        = entity_orientation_json->next;
-                entity_part_json                           = entity_data_json->next;
-
-                if (
-                        !cJSON_IsNumber(entity_type_json)        ||
-                        !cJSON_IsNumber(entity_column_json)      ||
-                        !cJSON_IsNumber(entity_row_json)         ||
-                        !cJSON_IsNumber(entity_orientation_json) ||
-                        !cJSON_IsNumber(entity_data_json)
-                ) {
-                        send_message(MESSAGE_ERROR, "Failed to parse level: Failed to parse entity %d: JSON data is invalid", (int)entity_index);
-                        return false;
-                }
-
-                const enum EntityType entity_type         = (enum EntityType)(uint8_t)entity_type_json->valuedouble;
-                const uint8_t entity_column               = (uint8_t)entity_column_json->valuedouble;
-                const uint8_t entity_row                  = (uint8_t)entity_row_json->valuedouble;
-                const enum Orientation entity_orientation = (enum Orientation)(uint8_t)entity_orientation_json->valuedouble;
-                const uint16_t entity_data                = (uint16_t)entity_data_json->valuedouble;
+        const size_t step_count = get_step_history_length(&level->implementation->step_history);
+        if (step_count > 0ULL) {
+                struct Geometry *const timeline_geometry = level->implementation->timeline_geometry;
+                clear_geometry(timeline_geometry);
 
-                struct Entity *const entity = create_entity(level, entity_type, entity_column, entity_row, entity_orientation);
-                level->implementation->entities[entity_index] = entity;
+                const float timeline_x = level->implementation->timeline_x;
+                const float timeline_y = level->implementation->timeline_y;
+                const float timeline_width = level->implementation->timeline_width;
+                const float timeline_line_width = tile_radius / 5.0f;
+                const float knob_x = timeline_x + timeline_width * (float)level->implementation->step_history.step_count / (float)step_count;
 
-                if (entity_type == ENTITY_PLAYER) {
-                        ++level->implementation->player_count;
+                set_geometry_color(timeline_geometry, COLOR_GOLD, COLOR_OPAQUE);
+                write_line_geometry(timeline_geometry, timeline_x, timeline_y, timeline_x + timeline_width, timeline_y, timeline_line_width, LINE_CAP_BOTH);
+                set_geometry_color(timeline_geometry, COLOR_LIGHT_YELLOW, COLOR_OPAQUE);
+                write_line_geometry(timeline_geometry, timeline_x, timeline_y, knob_x, timeline_y, timeline_line_width, LINE_CAP_BOTH);
 
-                        if (entity_data == 1) {
-#ifndef NDEBUG
-                                if (level->implementation->current_player_index != UINT16_MAX) {
-                                        send_message(MESSAGE_WARNING, "Multiple intially selected players found while parsing level");
-                                }
-#endif
+                set_geometry_color(timeline_geometry, COLOR_GOLD, COLOR_OPAQUE);
+                write_hexagon_geometry(timeline_geometry, knob_x, timeline_y, tile_radius / 2.5f + timeline_line_width / 2.0f, 0.0f);
+                set_geometry_color(timeline_geometry, COLOR_YELLOW, COLOR_OPAQUE);
+                write_hexagon_geometry(timeline_geometry, knob_x, timeline_y, tile_radius / 2.5f - timeline_line_width / 2.0f, 0.0f);
 
-                                level->implementation->current_player_index = entity_index;
-                        }
-                }
+                render_geometry(timeline_geometry);
         }
 
-        if (level->implementation->current_player_index == UINT16_MAX) {
-                send_message(MESSAGE_ERROR, "Failed to parse level: No initially selected player found");
-                return false;
-        }
-
-        const int joints_length = cJSON_GetArraySize(joints_json);
-        if (joints_length % LEVEL_DATA_JOINT_STRIDE != 0) {
-                send_message(MESSAGE_ERROR, "Failed to parse level: Joints array length of %d is not a multiple of %d", joints_length, LEVEL_DATA_JOINT_STRIDE);
-                return false;
-        }
-
-        level->implementation->joint_count = (uint16_t)(joints_length / LEVEL_DATA_JOINT_STRIDE);
-        level->implementation->joints = (struct Joint *)xmalloc(level->implementation->joint_count * sizeof(struct Joint));
-
-        const cJSON *joint_part_json = joints_json->child;
-        for (uint16_t joint_index = 0; joint_index < level->implementation->joint_count; ++joint_index) {
-                const cJSON *const joint_type_json    = joint_part_json;
-                const cJSON *const joint_block1_index = joint_type_json->next;
-                const cJSON *const joint_block2_index = joint_block1_index->next;
-                joint_part_json                       = joint_block2_index->next;
-
-                if (
-                        !cJSON_IsNumber(joint_type_json)    ||
-                        !cJSON_IsNumber(joint_block1_index) ||
-                        !cJSON_IsNumber(joint_block2_index)
-                ) {
-                        send_message(MESSAGE_ERROR, "Failed to parse level: Failed to parse joint %d: JSON data is invalid", (int)joint_index);
-                        return false;
-                }
-
-                level->implementation->joints[joint_index].type = (enum JointType)(int)joint_type_json->valuedouble;
-                level->implementation->joints[joint_index].block1 = level->implementation->entities[(uint16_t)joint_block1_index->valuedouble];
-                level->implementation->joints[joint_index].block2 = level->implementation->entities[(uint16_t)joint_block2_index->valuedouble];
-
-                // TODO: Validate by making sure both 'block1' and 'block2' are block entities
+        for (uint16_t entity_index = 0; entity_index < level->implementation->state.entity_count; ++entity_index) {
+                update_entity(level->implementation->entities[entity_index], delta_time);
         }
-
-        return true;
 }
 
 static void resize_level(struct Level *const level) {
+        if (!level->implementation->context.presenting) {
+                return;
+        }
+
         int drawable_width, drawable_height;
-        SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+        SDL_GetRendererOutputSize(level->implementation->context.renderer, &drawable_width, &drawable_height);
 
         const float grid_padding = fminf((float)drawable_width, (float)drawable_height) / 10.0f;
 
@@ -1113,12 +1132,17 @@ static void resize_level(struct Level *const level) {
         grid_metrics->bounding_y -= thickness / 2.0f;
         grid_metrics->grid_y -= thickness / 2.0f;
 
+        // The timeline sits in the padding below the grid
+        level->implementation->timeline_x = grid_padding;
+        level->implementation->timeline_y = (float)drawable_height - grid_padding / 2.0f;
+        level->implementation->timeline_width = (float)drawable_width - grid_padding * 2.0f;
+
         clear_geometry(level->implementation->grid_geometry);
 
         set_geometry_color(level->implementation->grid_geometry, COLOR_GOLD, COLOR_OPAQUE);
         for (uint8_t row = 0; row < level->rows; ++row) {
                 for (uint8_t column = 0; column < level->columns; ++column) {
-                        const enum TileType tile_type = level->implementation->tiles[(size_t)row * (size_t)level->columns + (size_t)column];
+                        const enum TileType tile_type = level->implementation->state.tiles[(size_t)row * (size_t)level->columns + (size_t)column];
                         if (tile_type == TILE_EMPTY || tile_type == TILE_SLAB) {
                                 continue;
                         }
@@ -1132,7 +1156,7 @@ static void resize_level(struct Level *const level) {
 
                         if (get_hexagon_neighbor((size_t)column, (size_t)row, HEXAGON_NEIGHBOR_BOTTOM, &level->implementation->grid_metrics, &neighbor_column, &neighbor_row)) {
                                 const size_t neighbor_index = neighbor_row * level->implementation->grid_metrics.columns + neighbor_column;
-                                const enum TileType neighbor_tile_type = level->implementation->tiles[neighbor_index];
+                                const enum TileType neighbor_tile_type = level->implementation->state.tiles[neighbor_index];
                                 if (neighbor_tile_type != TILE_EMPTY) {
                                         thickness_mask &= ~HEXAGON_THICKNESS_MASK_BOTTOM;
                                 }
@@ -1140,7 +1164,7 @@ static void resize_level(struct Level *const level) {
 
                         if (get_hexagon_neighbor((size_t)column, (size_t)row, HEXAGON_NEIGHBOR_BOTTOM_LEFT, &level->implementation->grid_metrics, &neighbor_column, &neighbor_row)) {
                                 const size_t neighbor_index = neighbor_row * level->implementation->grid_metrics.columns + neighbor_column;
-                                const enum TileType neighbor_tile_type = level->implementation->tiles[neighbor_index];
+                                const enum TileType neighbor_tile_type = level->implementation->state.tiles[neighbor_index];
                                 if (neighbor_tile_type != TILE_EMPTY) {
                                         thickness_mask &= ~HEXAGON_THICKNESS_MASK_LEFT;
                                 }
@@ -1148,7 +1172,7 @@ static void resize_level(struct Level *const level) {
 
                         if (get_hexagon_neighbor((size_t)column, (size_t)row, HEXAGON_NEIGHBOR_BOTTOM_RIGHT, &level->implementation->grid_metrics, &neighbor_column, &neighbor_row)) {
                                 const size_t neighbor_index = neighbor_row * level->implementation->grid_metrics.columns + neighbor_column;
-                                const enum TileType neighbor_tile_type = level->implementation->tiles[neighbor_index];
+                                const enum TileType neighbor_tile_type = level->implementation->state.tiles[neighbor_index];
                                 if (neighbor_tile_type != TILE_EMPTY) {
                                         thickness_mask &= ~HEXAGON_THICKNESS_MASK_RIGHT;
                                 }
@@ -1160,7 +1184,7 @@ static void resize_level(struct Level *const level) {
 
         for (uint8_t row = 0; row < level->rows; ++row) {
                 for (uint8_t column = 0; column < level->columns; ++column) {
-                        const enum TileType tile_type = level->implementation->tiles[(size_t)row * (size_t)level->columns + (size_t)column];
+                        const enum TileType tile_type = level->implementation->state.tiles[(size_t)row * (size_t)level->columns + (size_t)column];
                         if (tile_type == TILE_EMPTY || tile_type == TILE_SLAB) {
                                 continue;
                         }
@@ -1187,7 +1211,7 @@ static void resize_level(struct Level *const level) {
 
         for (uint8_t row = 0; row < level->rows; ++row) {
                 for (uint8_t column = 0; column < level->columns; ++column) {
-                        const enum TileType tile_type = level->implementation->tiles[(size_t)row * (size_t)level->columns + (size_t)column];
+                        const enum TileType tile_type = level->implementation->state.tiles[(size_t)row * (size_t)level->columns + (size_t)column];
                         if (tile_type != TILE_SLAB) {
                                 continue;
                         }
@@ -1208,7 +1232,7 @@ static void resize_level(struct Level *const level) {
                 }
         }
 
-        for (uint16_t entity_index = 0; entity_index < level->implementation->entity_count; ++entity_index) {
+        for (uint16_t entity_index = 0; entity_index < level->implementation->state.entity_count; ++entity_index) {
                 resize_entity(level->implementation->entities[entity_index], level->implementation->grid_metrics.tile_radius);
         }
 }
\ No newline at end of file
@@ -5,15 +5,23 @@
 #include <stdbool.h>
 
 #include "SDL_events.h"
+#include "SDL_render.h"
+#include "SDL_video.h"
 
+#include "Audio.h"
 #include "Defines.h"
-
-enum TileType {
-        TILE_EMPTY,
-        TILE_CELL,
-        TILE_SPOT,
-        TILE_SLAB,
-        TILE_COUNT
+#include "State.h"
+
+// Everything a level reaches for outside of itself is given to it here. A level without presentation never touches
+// the window, the renderer, the drawables or the audio, so any number of them can be simulated at once on any threads
+// as long as each one is only ever used from one thread at a time
+struct LevelContext {
+        bool presenting;
+        SDL_Window *window;
+        SDL_Renderer *renderer;
+        void (*play_sound)(const enum Sound sound); // NULL keeps the level quiet
+        bool hinting;   // Hints are searched for on a thread of their own, one for every level
+        bool recording; // The inputs are recorded into a replay that is saved once the level is deinitialized
 };
 
 struct LevelImplementation;
@@ -26,20 +34,44 @@ struct Level {
         struct LevelImplementation *implementation;
 };
 
-struct Level *load_level(const size_t number);
+// The context is copied, the window and the renderer only have to outlive the level if it is presenting
+struct Level *load_level(const size_t number, const struct LevelContext *const context);
 
 void destroy_level(struct Level *const level);
 
-bool initialize_level(struct Level *const level, const size_t number);
+bool initialize_level(struct Level *const level, const size_t number, const struct LevelContext *const context);
 
 void deinitialize_level(struct Level *const level);
 
 bool level_receive_event(struct Level *const level, const SDL_Event *const event);
 
+// Processes the input just like the matching key would, which is how a level without presentation gets played
+void submit_level_input(struct Level *const level, const enum Input input);
+
 void update_level(struct Level *const level, const double delta_time);
 
 char *get_level_title(struct Level *const level);
 
+uint64_t get_level_state_hash(const struct Level *const level);
+
+// The fewest moves the level can be won in as worked out by the solver at build time, zero if the level has none
+size_t get_level_par_move_count(const struct Level *const level);
+
+// Hints are searched for in the background and show up in 'get_level_hint' once they are found, which is INPUT_NONE
+// until then and again after the next change to the level
+void request_level_hint(struct Level *const level);
+
+enum Input get_level_hint(const struct Level *const level);
+
+// Puts the level back to how it was loaded without reading the level file again
+void restart_level(struct Level *const level);
+
+// Jumps straight to the given step of the history without animating the steps in between, the steps after it can
+// still be redone until a new step is taken. Returns false if nothing changed
+bool seek_level(struct Level *const level, const size_t step_index);
+
+void query_level_timeline(const struct Level *const level, size_t *const out_step_index, size_t *const out_step_count);
+
 struct Entity;
 bool query_level_tile(
         const struct Level *const level,
@@ -49,47 +81,4 @@ bool query_level_tile(
         struct Entity **const out_entity,
         float *const out_x,
         float *const out_y
-);
-
-enum Input {
-        INPUT_FORWARD,
-        INPUT_BACKWARD,
-        INPUT_LEFT,
-        INPUT_RIGHT,
-        INPUT_SWITCH,
-        INPUT_UNDO,
-        INPUT_REDO,
-        INPUT_NONE
-};
-
-enum ChangeType {
-        CHANGE_WALK,
-        CHANGE_TURN,
-        CHANGE_PUSH,
-        CHANGE_PUSHED,
-        CHANGE_TOGGLE,
-        CHANGE_BLOCKED,
-        CHANGE_INVALID
-};
-
-struct Change {
-        enum Input input;
-        enum ChangeType type;
-        struct Entity *entity;
-        union {
-                struct {
-                        uint8_t last_column, last_row;
-                        uint8_t next_column, next_row;
-                } move;
-                struct {
-                        enum Orientation last_orientation;
-                        enum Orientation next_orientation;
-                } turn;
-                struct {
-                        enum Orientation direction;
-                } face;
-                struct {
-                        bool focused;
-                } toggle;
-        };
-};
\ No newline at end of file
+);
\ No newline at end of file
@@ -6,6 +6,7 @@
 
 #include "Debug.h"
 #include "Defines.h"
+#include "Threads.h"
 
 #ifndef NDEBUG
 
@@ -22,6 +23,10 @@ static struct AllocationInformation *allocation_informations = NULL;
 static size_t active_allocations = 0ULL;
 static size_t active_bytes = 0ULL;
 static size_t peak_bytes = 0ULL;
+static size_t allocation_count = 0ULL;
+
+// The solver allocates from several threads at once
+static struct Mutex allocation_mutex = MUTEX_INITIALIZER;
 
 void flush_memory_leaks(void) {
         if (allocation_informations == NULL) {
@@ -43,6 +48,13 @@ void flush_memory_leaks(void) {
         }
 }
 
+size_t get_memory_allocation_count(void) {
+        lock_mutex(&allocation_mutex);
+        const size_t count = allocation_count;
+        unlock_mutex(&allocation_mutex);
+        return count;
+}
+
 static void track_allocation(void *const pointer, const size_t size, const char *const file, const int line, const char *const function) {
         struct AllocationInformation *const allocation_information = (struct AllocationInformation *)malloc(sizeof(struct AllocationInformation));
         if (allocation_information == NULL) {
@@ -55,10 +67,13 @@ static void track_allocation(void *const pointer, const size_t size, const char
         allocation_information->file = file;
         allocation_information->line = line;
         allocation_information->function = function;
+
+        lock_mutex(&allocation_mutex);
         allocation_information->next = allocation_informations;
         allocation_informations = allocation_information;
 
         ++active_allocations;
+        ++allocation_count;
         active_bytes += size;
 
         if (active_bytes > peak_bytes) {
@@ -71,9 +86,12 @@ static void track_allocation(void *const pointer, const size_t size, const char
                         );
                 }
         }
+
+        unlock_mutex(&allocation_mutex);
 }
 
 static void remove_allocation(void *const pointer, const char *const file, const int line, const char *const function) {
+        lock_mutex(&allocation_mutex);
         struct AllocationInformation **current_allocation_information = &allocation_informations;
 
         while (*current_allocation_information != NULL) {
@@ -84,6 +102,8 @@ static void remove_allocation(void *const pointer, const char *const file, const
                         --active_allocations;
 
                         *current_allocation_information = removed_allocation_information->next;
+                        unlock_mutex(&allocation_mutex);
+
                         free(removed_allocation_information);
                         return;
                 }
@@ -91,6 +111,7 @@ static void remove_allocation(void *const pointer, const char *const file, const
                 current_allocation_information = &(*current_allocation_information)->next;
         }
 
+        unlock_mutex(&allocation_mutex);
         send_message(MESSAGE_WARNING, "xfree(%p): Pointer is unrecognized at %s:%d in %s()", pointer, file, line, function);
 }
 
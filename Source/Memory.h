@@ -7,6 +7,9 @@
 
 void flush_memory_leaks(void);
 
+// Every allocation that was ever made, which tells whether some stretch of code allocated at all
+size_t get_memory_allocation_count(void);
+
 void *track_malloc(const size_t size, const char *const file, const int line, const char *const function);
 
 void *track_calloc(const size_t count, const size_t size, const char *const file, const int line, const char *const function);
@@ -35,6 +38,11 @@ static inline void flush_memory_leaks(void) {
         return;
 }
 
+// Allocations are only counted while they are tracked
+static inline size_t get_memory_allocation_count(void) {
+        return 0ULL;
+}
+
 static inline void *xmalloc(const size_t size) {
         void *const allocated = malloc(size);
         if (allocated == NULL) {
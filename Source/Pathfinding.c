@@ -0,0 +1,171 @@
+#include "Pathfinding.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "Hexagons.h"
+#include "State.h"
+#include "Memory.h"
+#include "Defines.h"
+#include "Debug.h"
+
+// A node is a tile together with the orientation the player faces on it
+#define PATH_NODE(tile_index, orientation) ((uint16_t)((tile_index) * ORIENTATION_COUNT + (orientation)))
+
+_Static_assert(LEVEL_DIMENSION_LIMIT * LEVEL_DIMENSION_LIMIT * ORIENTATION_COUNT < PATH_NODE_NONE, "Path nodes don't fit in 16 bits");
+
+void initialize_path_finder(struct PathFinder *const path_finder, const struct LevelState *const state) {
+        path_finder->columns = state->columns;
+        path_finder->rows = state->rows;
+        path_finder->tile_count = state->tile_count;
+
+        const size_t node_count = (size_t)state->tile_count * ORIENTATION_COUNT;
+        path_finder->neighbors = (uint16_t *)xmalloc(node_count * sizeof(uint16_t));
+        path_finder->node_marks = (uint16_t *)xcalloc(node_count, sizeof(uint16_t));
+        path_finder->node_mark = 0;
+        path_finder->node_parents = (uint16_t *)xmalloc(node_count * sizeof(uint16_t));
+        path_finder->node_inputs = (uint8_t *)xmalloc(node_count * sizeof(uint8_t));
+        path_finder->node_queue = (uint16_t *)xmalloc(node_count * sizeof(uint16_t));
+
+        for (uint8_t row = 0; row < state->rows; ++row) {
+                for (uint8_t column = 0; column < state->columns; ++column) {
+                        const uint16_t tile_index = (uint16_t)(row * state->columns + column);
+
+                        for (int orientation = 0; orientation < ORIENTATION_COUNT; ++orientation) {
+                                size_t neighbor_column, neighbor_row;
+                                path_finder->neighbors[PATH_NODE(tile_index, orientation)] =
+                                        orientation_advance((enum Orientation)orientation, column, row, state->columns, state->rows, &neighbor_column, &neighbor_row)
+                                        ? (uint16_t)(neighbor_row * state->columns + neighbor_column)
+                                        : PATH_NODE_NONE;
+                        }
+                }
+        }
+}
+
+void deinitialize_path_finder(struct PathFinder *const path_finder) {
+        if (path_finder->neighbors != NULL) {
+                xfree(path_finder->neighbors);
+        }
+
+        if (path_finder->node_marks != NULL) {
+                xfree(path_finder->node_marks);
+        }
+
+        if (path_finder->node_parents != NULL) {
+                xfree(path_finder->node_parents);
+        }
+
+        if (path_finder->node_inputs != NULL) {
+                xfree(path_finder->node_inputs);
+        }
+
+        if (path_finder->node_queue != NULL) {
+                xfree(path_finder->node_queue);
+        }
+
+        *path_finder = (struct PathFinder){0};
+}
+
+size_t get_path_finder_input_limit(const struct PathFinder *const path_finder) {
+        return (size_t)path_finder->tile_count * ORIENTATION_COUNT;
+}
+
+static inline bool is_tile_walkable(const struct LevelState *const state, const uint16_t tile_index) {
+        return tile_index != PATH_NODE_NONE && state->tiles[tile_index] != TILE_EMPTY && state->occupants[tile_index] == ENTITY_INDEX_NONE;
+}
+
+bool find_level_state_path(
+        struct PathFinder *const path_finder,
+        const struct LevelState *const state,
+        const uint8_t target_column,
+        const uint8_t target_row,
+        enum Input *const out_inputs,
+        size_t *const out_input_count
+) {
+        *out_input_count = 0ULL;
+
+        if (target_column >= path_finder->columns || target_row >= path_finder->rows) {
+                return false;
+        }
+
+        const struct EntityState *const player = &state->entities[state->current_player_index];
+        const uint16_t start_tile_index = (uint16_t)(player->row * path_finder->columns + player->column);
+        const uint16_t target_tile_index = (uint16_t)(target_row * path_finder->columns + target_column);
+
+        if (target_tile_index == start_tile_index) {
+                return true;
+        }
+
+        if (!is_tile_walkable(state, target_tile_index)) {
+                return false;
+        }
+
+        // A fresh mark tells apart the nodes of this search from the ones of earlier searches without clearing them
+        if (++path_finder->node_mark == 0) {
+                memset(path_finder->node_marks, 0, get_path_finder_input_limit(path_finder) * sizeof(uint16_t));
+                path_finder->node_mark = 1;
+        }
+
+        const uint16_t start_node = PATH_NODE(start_tile_index, player->orientation);
+        path_finder->node_marks[start_node] = path_finder->node_mark;
+        path_finder->node_parents[start_node] = PATH_NODE_NONE;
+
+        size_t queue_head = 0ULL;
+        size_t queue_tail = 0ULL;
+        path_finder->node_queue[queue_tail++] = start_node;
+
+        uint16_t found_node = PATH_NODE_NONE;
+        while (queue_head < queue_tail && found_node == PATH_NODE_NONE) {
+                const uint16_t node = path_finder->node_queue[queue_head++];
+                const uint16_t tile_index = node / ORIENTATION_COUNT;
+                const enum Orientation orientation = (enum Orientation)(node % ORIENTATION_COUNT);
+
+                const uint16_t next_nodes[4] = {
+                        [INPUT_FORWARD]  = is_tile_walkable(state, path_finder->neighbors[node])
+                                ? PATH_NODE(path_finder->neighbors[node], orientation)
+                                : PATH_NODE_NONE,
+                        [INPUT_BACKWARD] = is_tile_walkable(state, path_finder->neighbors[PATH_NODE(tile_index, orientation_reverse(orientation))])
+                                ? PATH_NODE(path_finder->neighbors[PATH_NODE(tile_index, orientation_reverse(orientation))], orientation)
+                                : PATH_NODE_NONE,
+                        [INPUT_LEFT]     = PATH_NODE(tile_index, orientation_turn_left(orientation)),
+                        [INPUT_RIGHT]    = PATH_NODE(tile_index, orientation_turn_right(orientation))
+                };
+
+                for (int input = INPUT_FORWARD; input <= INPUT_RIGHT; ++input) {
+                        const uint16_t next_node = next_nodes[input];
+                        if (next_node == PATH_NODE_NONE || path_finder->node_marks[next_node] == path_finder->node_mark) {
+                                continue;
+                        }
+
+                        path_finder->node_marks[next_node] = path_finder->node_mark;
+                        path_finder->node_parents[next_node] = node;
+                        path_finder->node_inputs[next_node] = (uint8_t)input;
+                        path_finder->node_queue[queue_tail++] = next_node;
+
+                        if (next_node / ORIENTATION_COUNT == target_tile_index) {
+                                found_node = next_node;
+                                break;
+                        }
+                }
+        }
+
+        if (found_node == PATH_NODE_NONE) {
+                return false;
+        }
+
+        // The parents lead from the target back to the start, so the inputs get written back to front
+        size_t input_count = 0ULL;
+        for (uint16_t node = found_node; node != start_node; node = path_finder->node_parents[node]) {
+                ++input_count;
+        }
+
+        size_t input_index = input_count;
+        for (uint16_t node = found_node; node != start_node; node = path_finder->node_parents[node]) {
+                out_inputs[--input_index] = (enum Input)path_finder->node_inputs[node];
+        }
+
+        *out_input_count = input_count;
+        return true;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "Defines.h"
+#include "Hexagons.h"
+#include "State.h"
+
+// Walking paths are searched over (tile, orientation) pairs because the player can only step forward or backward
+// and has to turn to face anywhere else. Every input costs the same, so a breadth first search finds the path with
+// the fewest inputs. The neighbors of every tile are worked out once per level and the search reuses the same
+// buffers for every query, so a query doesn't allocate and never looks at the grid geometry
+
+#define PATH_NODE_NONE UINT16_MAX
+
+struct PathFinder {
+        uint8_t columns;
+        uint8_t rows;
+        uint16_t tile_count;
+        uint16_t *neighbors;
+        uint16_t *node_marks;
+        uint16_t node_mark;
+        uint16_t *node_parents;
+        uint8_t *node_inputs;
+        uint16_t *node_queue;
+};
+
+void initialize_path_finder(struct PathFinder *const path_finder, const struct LevelState *const state);
+
+void deinitialize_path_finder(struct PathFinder *const path_finder);
+
+// The buffer for the inputs has to be able to hold 'get_path_finder_input_limit' inputs. The path only walks over
+// tiles that the current player can stand on without pushing anything and the player may face any way at the end
+bool find_level_state_path(
+        struct PathFinder *const path_finder,
+        const struct LevelState *const state,
+        const uint8_t target_column,
+        const uint8_t target_row,
+        enum Input *const out_inputs,
+        size_t *const out_input_count
+);
+
+size_t get_path_finder_input_limit(const struct PathFinder *const path_finder);
\ No newline at end of file
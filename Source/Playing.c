@@ -6,6 +6,7 @@
 
 #include "Button.h"
 #include "Audio.h"
+#include "Context.h"
 #include "Persistent.h"
 #include "Animation.h"
 #include "Defines.h"
@@ -17,16 +18,20 @@
 // NOTE: This is hardcoded for now, it might/should probably not be later
 #define LEVEL_COUNT (7ULL)
 
-#define MOVE_COUNT_LABEL_BUFFER_SIZE (16ULL)
+#define MOVE_COUNT_LABEL_BUFFER_SIZE (32ULL)
 #define LEVEL_TITLE_LABEL_BUFFER_SIZE (64ULL)
 
 static struct Level level;
 static size_t displayed_move_count = 0ULL;
+static size_t displayed_par_move_count = 0ULL;
 
 static float move_count_scale = 1.0f;
 static struct Animation move_count_pulse;
 static struct Text level_number_label;
 static struct Text move_count_label;
+static struct Text hint_label;
+static enum Input displayed_hint_input = INPUT_NONE;
+static struct Button hint_button;
 static struct Button undo_button;
 static struct Button redo_button;
 static struct Button restart_button;
@@ -74,6 +79,17 @@ static void quit_callback(void *) {
         trigger_transition_layer(back_to_main_menu, NULL);
 }
 
+static const char *const hint_strings[] = {
+        [INPUT_FORWARD]  = "Hint: Move forward",
+        [INPUT_BACKWARD] = "Hint: Move backward",
+        [INPUT_LEFT]     = "Hint: Turn left",
+        [INPUT_RIGHT]    = "Hint: Turn right",
+        [INPUT_SWITCH]   = "Hint: Switch players",
+        [INPUT_UNDO]     = "Hint: Undo",
+        [INPUT_REDO]     = "Hint: Redo",
+        [INPUT_NONE]     = ""
+};
+
 static void toggle_sound_callback(void *const data) {
         (void)data;
 
@@ -101,6 +117,17 @@ static bool initialize_playing_scene(void) {
         initialize_text(&move_count_label, "Moves: 0", FONT_HEADER_1);
         set_text_color(&move_count_label, COLOR_YELLOW, 255);
 
+        initialize_text(&hint_label, "Hint: _", FONT_HEADER_2);
+        set_text_color(&hint_label, COLOR_YELLOW, 255);
+
+        initialize_button(&hint_button, true);
+        hint_button.grid_anchor_x = 1.0f;
+        hint_button.tile_offset_column = -6;
+        hint_button.callback = simulate_key_press;
+        hint_button.callback_data = (void *)(intptr_t)SDLK_h;
+        set_button_tooltip_text(&hint_button, "Hint");
+        set_button_surface_text(&hint_button, "?");
+
         initialize_button(&undo_button, true);
         undo_button.grid_anchor_x = 1.0f;
         undo_button.tile_offset_column = -5;
@@ -145,6 +172,7 @@ static bool initialize_playing_scene(void) {
         set_button_tooltip_text(&music_button, "Toggle Music");
         set_button_surface_icon(&music_button, get_persistent_music_enabled() ? ICON_MUSIC_ON : ICON_MUSIC_OFF);
 
+        hint_button.thickness_mask  &= ~HEXAGON_THICKNESS_MASK_RIGHT;
         redo_button.thickness_mask  &= ~HEXAGON_THICKNESS_MASK_LEFT;
         redo_button.thickness_mask  &= ~HEXAGON_THICKNESS_MASK_RIGHT;
         quit_button.thickness_mask  &= ~HEXAGON_THICKNESS_MASK_LEFT;
@@ -185,7 +213,20 @@ static void present_level(void *const data) {
                 return;
         }
 
-        if (!initialize_level(&level, current_level_number)) {
+        // The level being played is the only one that presents, plays sounds and gives hints
+        struct LevelContext level_context = {0};
+        level_context.presenting = true;
+        level_context.window = get_context_window();
+        level_context.renderer = get_context_renderer();
+        level_context.play_sound = play_sound;
+        level_context.hinting = true;
+
+        // Every session would leave a replay behind, so only builds that ask for replays record them
+#ifdef RECORD_REPLAYS
+        level_context.recording = true;
+#endif
+
+        if (!initialize_level(&level, current_level_number, &level_context)) {
                 send_message(MESSAGE_ERROR, "Failed to load next level: Returning to main menu");
                 scene_manager_present_scene(SCENE_MAIN_MENU);
                 return;
@@ -213,11 +254,17 @@ static bool playing_scene_receive_event(const SDL_Event *const event) {
         }
 
         if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_r) {
-                trigger_transition_layer(present_level, (void *)(uintptr_t)current_level_number);
+                restart_level(&level);
+                return true;
+        }
+
+        if (event->type == SDL_KEYDOWN && event->key.keysym.sym == SDLK_h) {
+                request_level_hint(&level);
                 return true;
         }
 
         if (
+                button_receive_event(&hint_button, event)    ||
                 button_receive_event(&undo_button, event)    ||
                 button_receive_event(&redo_button, event)    ||
                 button_receive_event(&restart_button, event) ||
@@ -238,13 +285,24 @@ static bool playing_scene_receive_event(const SDL_Event *const event) {
 static void update_playing_scene(const double delta_time) {
         update_level(&level, delta_time);
 
-        if (displayed_move_count != level.move_count) {
+        // The par comes with the level, so it only changes when the next level gets loaded and that shouldn't pulse
+        const size_t par_move_count = get_level_par_move_count(&level);
+        if (displayed_move_count != level.move_count || displayed_par_move_count != par_move_count) {
+                if (displayed_move_count != level.move_count) {
+                        start_animation(&move_count_pulse, 0ULL);
+                }
+
                 displayed_move_count = level.move_count;
+                displayed_par_move_count = par_move_count;
 
                 char move_count_string[MOVE_COUNT_LABEL_BUFFER_SIZE];
-                snprintf(move_count_string, sizeof(move_count_string), "Moves: %zu", displayed_move_count);
+                if (displayed_par_move_count != 0ULL) {
+                        snprintf(move_count_string, sizeof(move_count_string), "Moves: %zu / %zu", displayed_move_count, displayed_par_move_count);
+                } else {
+                        snprintf(move_count_string, sizeof(move_count_string), "Moves: %zu", displayed_move_count);
+                }
+
                 set_text_string(&move_count_label, move_count_string);
-                start_animation(&move_count_pulse, 0ULL);
         }
 
         int drawable_width, drawable_height;
@@ -267,6 +325,24 @@ static void update_playing_scene(const double delta_time) {
         move_count_label.absolute_offset_y = padding * 1.5f + (float)move_count_label_height;
         update_text(&move_count_label);
 
+        // The hint goes away by itself with the next change to the level
+        const enum Input hint_input = get_level_hint(&level);
+        if (hint_input != INPUT_NONE) {
+                if (displayed_hint_input != hint_input) {
+                        displayed_hint_input = hint_input;
+                        set_text_string(&hint_label, hint_strings[hint_input]);
+                }
+
+                size_t hint_label_offset;
+                get_text_dimensions(&move_count_label, NULL, &hint_label_offset);
+
+                hint_label.absolute_offset_x = padding;
+                hint_label.absolute_offset_y = move_count_label.absolute_offset_y + padding * 0.5f + (float)hint_label_offset;
+                update_text(&hint_label);
+        }
+
+        update_button(&hint_button, delta_time);
+
         update_button(&undo_button, delta_time);
         update_button(&redo_button, delta_time);
         update_button(&restart_button, delta_time);
@@ -283,6 +359,8 @@ static void terminate_playing_scene(void) {
         deinitialize_animation(&move_count_pulse);
         deinitialize_text(&level_number_label);
         deinitialize_text(&move_count_label);
+        deinitialize_text(&hint_label);
+        deinitialize_button(&hint_button);
         deinitialize_button(&undo_button);
         deinitialize_button(&redo_button);
         deinitialize_button(&restart_button);
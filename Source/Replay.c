@@ -0,0 +1,482 @@
+#include "Replay.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "State.h"
+#include "History.h"
+#include "Memory.h"
+#include "Defines.h"
+#include "Debug.h"
+
+#define REPLAY_MAGIC "SBRP"
+#define REPLAY_VERSION 1U
+#define REPLAY_FLAG_TIMED 1U
+#define REPLAY_HEADER_SIZE 36ULL
+#define REPLAY_INITIAL_CAPACITY 64ULL
+
+_Static_assert(INPUT_NONE < REPLAY_CODE_RESTART && REPLAY_CODE_RESTART <= 0xF, "Replay codes don't fit in a nibble");
+
+// FNV-1a, the level hash only has to tell versions of a level apart and stay the same on every platform
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x00000100000001B3ULL
+
+static inline uint64_t hash_bytes(uint64_t hash, const uint8_t *const bytes, const size_t size) {
+        for (size_t index = 0ULL; index < size; ++index) {
+                hash = (hash ^ bytes[index]) * FNV_PRIME;
+        }
+
+        return hash;
+}
+
+static inline uint64_t hash_integer(const uint64_t hash, const uint64_t value, const size_t size) {
+        uint8_t bytes[8ULL];
+        for (size_t index = 0ULL; index < size; ++index) {
+                bytes[index] = (uint8_t)(value >> (index * 8ULL));
+        }
+
+        return hash_bytes(hash, bytes, size);
+}
+
+uint64_t hash_replay_level(const struct LevelState *const state) {
+        uint64_t hash = FNV_OFFSET_BASIS;
+        hash = hash_integer(hash, state->columns, 1ULL);
+        hash = hash_integer(hash, state->rows, 1ULL);
+
+        for (uint16_t tile_index = 0; tile_index < state->tile_count; ++tile_index) {
+                hash = hash_integer(hash, (uint64_t)state->tiles[tile_index], 1ULL);
+        }
+
+        hash = hash_integer(hash, state->entity_count, 2ULL);
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                const struct EntityState *const entity = &state->entities[entity_index];
+                const uint8_t bytes[] = {entity->type, entity->column, entity->row, entity->orientation};
+                hash = hash_bytes(hash, bytes, sizeof(bytes));
+        }
+
+        hash = hash_integer(hash, state->joint_count, 2ULL);
+        for (uint16_t joint_index = 0; joint_index < state->joint_count; ++joint_index) {
+                const struct Joint *const joint = &state->joints[joint_index];
+                hash = hash_integer(hash, (uint64_t)joint->type, 1ULL);
+                hash = hash_integer(hash, joint->block1_index, 2ULL);
+                hash = hash_integer(hash, joint->block2_index, 2ULL);
+        }
+
+        return hash_integer(hash, state->current_player_index, 2ULL);
+}
+
+void initialize_replay(struct Replay *const replay, const uint16_t level_number, const struct LevelState *const state, const bool timed) {
+        *replay = (struct Replay){0};
+        replay->level_number = level_number;
+        replay->level_hash = hash_replay_level(state);
+        replay->timed = timed;
+        replay->final_state_hash = hash_level_state(state);
+}
+
+void deinitialize_replay(struct Replay *const replay) {
+        if (replay->seek_points != NULL) {
+                xfree(replay->seek_points);
+        }
+
+        if (replay->times != NULL) {
+                xfree(replay->times);
+        }
+
+        if (replay->codes != NULL) {
+                xfree(replay->codes);
+        }
+
+        *replay = (struct Replay){0};
+}
+
+static void reserve_replay_codes(struct Replay *const replay, const size_t code_count) {
+        if (code_count <= replay->code_capacity) {
+                return;
+        }
+
+        size_t next_capacity = MAXIMUM_VALUE(replay->code_capacity * 2ULL, REPLAY_INITIAL_CAPACITY);
+        while (next_capacity < code_count) {
+                next_capacity *= 2ULL;
+        }
+
+        replay->codes = (uint8_t *)xrealloc(replay->codes, next_capacity * sizeof(uint8_t));
+        if (replay->timed) {
+                replay->times = (uint32_t *)xrealloc(replay->times, next_capacity * sizeof(uint32_t));
+        }
+
+        replay->code_capacity = next_capacity;
+}
+
+static void add_replay_seek_point(struct Replay *const replay, const uint32_t input_count, const uint64_t state_hash) {
+        if (replay->seek_point_count == replay->seek_point_capacity) {
+                replay->seek_point_capacity = MAXIMUM_VALUE(replay->seek_point_capacity * 2ULL, REPLAY_INITIAL_CAPACITY);
+                replay->seek_points = (struct ReplaySeekPoint *)xrealloc(replay->seek_points, replay->seek_point_capacity * sizeof(struct ReplaySeekPoint));
+        }
+
+        replay->seek_points[replay->seek_point_count++] = (struct ReplaySeekPoint){input_count, state_hash};
+}
+
+// Seek points go after whole recorded inputs, since the state hash in between repeats isn't known
+static void record_replay_codes(struct Replay *const replay, const uint8_t code, const size_t repeat_count, const uint32_t time, const uint64_t state_hash) {
+        if (repeat_count == 0ULL) {
+                return;
+        }
+
+        reserve_replay_codes(replay, replay->code_count + repeat_count);
+        for (size_t repeat_index = 0ULL; repeat_index < repeat_count; ++repeat_index) {
+                replay->codes[replay->code_count] = code;
+                if (replay->timed) {
+                        replay->times[replay->code_count] = time;
+                }
+
+                ++replay->code_count;
+        }
+
+        const size_t last_seek_input_count = replay->seek_point_count > 0ULL ? replay->seek_points[replay->seek_point_count - 1ULL].input_count : 0ULL;
+        if (replay->code_count - last_seek_input_count >= REPLAY_SEEK_INTERVAL) {
+                add_replay_seek_point(replay, (uint32_t)replay->code_count, state_hash);
+        }
+
+        replay->final_state_hash = state_hash;
+}
+
+void record_replay_input(struct Replay *const replay, const enum Input input, const size_t repeat_count, const uint32_t time, const uint64_t state_hash) {
+        ASSERT_ALL(input < INPUT_NONE);
+        record_replay_codes(replay, (uint8_t)input, repeat_count, time, state_hash);
+}
+
+void record_replay_restart(struct Replay *const replay, const uint32_t time, const uint64_t state_hash) {
+        record_replay_codes(replay, (uint8_t)REPLAY_CODE_RESTART, 1ULL, time, state_hash);
+}
+
+// ================================================================================================
+// Encoding
+// ================================================================================================
+
+struct ReplayBuffer {
+        uint8_t *bytes;
+        size_t size;
+        size_t capacity;
+        size_t position;
+};
+
+static void write_replay_bytes(struct ReplayBuffer *const buffer, const void *const bytes, const size_t size) {
+        if (buffer->size + size > buffer->capacity) {
+                buffer->capacity = MAXIMUM_VALUE(buffer->capacity * 2ULL, buffer->size + size);
+                buffer->bytes = (uint8_t *)xrealloc(buffer->bytes, buffer->capacity);
+        }
+
+        memcpy(buffer->bytes + buffer->size, bytes, size);
+        buffer->size += size;
+}
+
+static void write_replay_integer(struct ReplayBuffer *const buffer, const uint64_t value, const size_t size) {
+        uint8_t bytes[8ULL];
+        for (size_t index = 0ULL; index < size; ++index) {
+                bytes[index] = (uint8_t)(value >> (index * 8ULL));
+        }
+
+        write_replay_bytes(buffer, bytes, size);
+}
+
+static void write_replay_varint(struct ReplayBuffer *const buffer, uint64_t value) {
+        uint8_t bytes[10ULL];
+        size_t size = 0ULL;
+        do {
+                bytes[size] = (uint8_t)(value & 0x7FU);
+                value >>= 7U;
+                bytes[size++] |= value != 0ULL ? 0x80U : 0U;
+        } while (value != 0ULL);
+
+        write_replay_bytes(buffer, bytes, size);
+}
+
+static bool read_replay_integer(struct ReplayBuffer *const buffer, const size_t size, uint64_t *const out_value) {
+        if (buffer->size - buffer->position < size) {
+                return false;
+        }
+
+        *out_value = 0ULL;
+        for (size_t index = 0ULL; index < size; ++index) {
+                *out_value |= (uint64_t)buffer->bytes[buffer->position++] << (index * 8ULL);
+        }
+
+        return true;
+}
+
+static bool read_replay_varint(struct ReplayBuffer *const buffer, uint64_t *const out_value) {
+        *out_value = 0ULL;
+        for (size_t shift = 0ULL; shift < 64ULL; shift += 7ULL) {
+                if (buffer->position == buffer->size) {
+                        return false;
+                }
+
+                const uint8_t byte = buffer->bytes[buffer->position++];
+                *out_value |= (uint64_t)(byte & 0x7FU) << shift;
+                if ((byte & 0x80U) == 0U) {
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+bool write_replay(const struct Replay *const replay, const char *const path) {
+        struct ReplayBuffer buffer = {0};
+
+        write_replay_bytes(&buffer, REPLAY_MAGIC, 4ULL);
+        write_replay_integer(&buffer, REPLAY_VERSION, 1ULL);
+        write_replay_integer(&buffer, replay->timed ? REPLAY_FLAG_TIMED : 0U, 1ULL);
+        write_replay_integer(&buffer, replay->level_number, 2ULL);
+        write_replay_integer(&buffer, replay->level_hash, 8ULL);
+        write_replay_integer(&buffer, replay->code_count, 4ULL);
+        write_replay_integer(&buffer, replay->seek_point_count, 4ULL);
+        write_replay_integer(&buffer, replay->final_state_hash, 8ULL);
+        write_replay_integer(&buffer, REPLAY_SEEK_INTERVAL, 4ULL);
+
+        for (size_t code_index = 0ULL; code_index < replay->code_count; code_index += 2ULL) {
+                const uint8_t high = code_index + 1ULL < replay->code_count ? replay->codes[code_index + 1ULL] : 0U;
+                write_replay_integer(&buffer, (uint64_t)(replay->codes[code_index] | high << 4U), 1ULL);
+        }
+
+        if (replay->timed) {
+                uint32_t last_time = 0;
+                for (size_t code_index = 0ULL; code_index < replay->code_count; ++code_index) {
+                        write_replay_varint(&buffer, replay->times[code_index] - last_time);
+                        last_time = replay->times[code_index];
+                }
+        }
+
+        uint32_t last_input_count = 0;
+        for (size_t seek_point_index = 0ULL; seek_point_index < replay->seek_point_count; ++seek_point_index) {
+                const struct ReplaySeekPoint *const seek_point = &replay->seek_points[seek_point_index];
+                write_replay_varint(&buffer, seek_point->input_count - last_input_count);
+                write_replay_integer(&buffer, seek_point->state_hash, 8ULL);
+                last_input_count = seek_point->input_count;
+        }
+
+        FILE *const file = fopen(path, "wb");
+        if (file == NULL) {
+                send_message(MESSAGE_ERROR, "Failed to write replay \"%s\": %s", path, strerror(errno));
+                xfree(buffer.bytes);
+                return false;
+        }
+
+        const bool written = fwrite(buffer.bytes, 1ULL, buffer.size, file) == buffer.size;
+        if (fclose(file) != 0 || !written) {
+                send_message(MESSAGE_ERROR, "Failed to write replay \"%s\": %s", path, strerror(errno));
+                xfree(buffer.bytes);
+                return false;
+        }
+
+        xfree(buffer.bytes);
+        return true;
+}
+
+static bool parse_replay(struct Replay *const replay, struct ReplayBuffer *const buffer, const char *const path) {
+        if (buffer->size < REPLAY_HEADER_SIZE || memcmp(buffer->bytes, REPLAY_MAGIC, 4ULL) != 0) {
+                send_message(MESSAGE_ERROR, "Failed to read replay \"%s\": Not a replay", path);
+                return false;
+        }
+
+        buffer->position = 4ULL;
+
+        uint64_t version, flags, level_number, level_hash, code_count, seek_point_count, final_state_hash, seek_interval;
+        read_replay_integer(buffer, 1ULL, &version);
+        read_replay_integer(buffer, 1ULL, &flags);
+        read_replay_integer(buffer, 2ULL, &level_number);
+        read_replay_integer(buffer, 8ULL, &level_hash);
+        read_replay_integer(buffer, 4ULL, &code_count);
+        read_replay_integer(buffer, 4ULL, &seek_point_count);
+        read_replay_integer(buffer, 8ULL, &final_state_hash);
+        read_replay_integer(buffer, 4ULL, &seek_interval);
+
+        if (version != REPLAY_VERSION) {
+                send_message(MESSAGE_ERROR, "Failed to read replay \"%s\": Version %u isn't supported", path, (unsigned int)version);
+                return false;
+        }
+
+        // Every input takes at least half a byte and every seek point at least nine, which keeps a broken header from
+        // asking for more memory than the file could ever fill
+        if ((code_count + 1ULL) / 2ULL + seek_point_count * 9ULL > buffer->size - buffer->position) {
+                send_message(MESSAGE_ERROR, "Failed to read replay \"%s\": The file is cut short", path);
+                return false;
+        }
+
+        // The seek interval is only there for whoever reads the file by hand, every seek point has its own input count
+        (void)seek_interval;
+
+        *replay = (struct Replay){0};
+        replay->level_number = (uint16_t)level_number;
+        replay->level_hash = level_hash;
+        replay->timed = (flags & REPLAY_FLAG_TIMED) != 0ULL;
+        replay->final_state_hash = final_state_hash;
+
+        reserve_replay_codes(replay, (size_t)code_count);
+        for (size_t code_index = 0ULL; code_index < code_count; ++code_index) {
+                const uint8_t byte = buffer->bytes[buffer->position + code_index / 2ULL];
+                const uint8_t code = code_index % 2ULL == 0ULL ? (uint8_t)(byte & 0xFU) : (uint8_t)(byte >> 4U);
+                if (code == INPUT_NONE || code > REPLAY_CODE_RESTART) {
+                        send_message(MESSAGE_ERROR, "Failed to read replay \"%s\": Input %zu is invalid", path, code_index);
+                        deinitialize_replay(replay);
+                        return false;
+                }
+
+                replay->codes[code_index] = code;
+        }
+
+        replay->code_count = (size_t)code_count;
+        buffer->position += (replay->code_count + 1ULL) / 2ULL;
+
+        if (replay->timed) {
+                uint64_t time = 0ULL;
+                for (size_t code_index = 0ULL; code_index < replay->code_count; ++code_index) {
+                        uint64_t delta;
+                        if (!read_replay_varint(buffer, &delta)) {
+                                send_message(MESSAGE_ERROR, "Failed to read replay \"%s\": The file is cut short", path);
+                                deinitialize_replay(replay);
+                                return false;
+                        }
+
+                        time += delta;
+                        replay->times[code_index] = (uint32_t)time;
+                }
+        }
+
+        uint64_t input_count = 0ULL;
+        for (size_t seek_point_index = 0ULL; seek_point_index < seek_point_count; ++seek_point_index) {
+                uint64_t delta, state_hash;
+                if (!read_replay_varint(buffer, &delta) || !read_replay_integer(buffer, 8ULL, &state_hash)) {
+                        send_message(MESSAGE_ERROR, "Failed to read replay \"%s\": The file is cut short", path);
+                        deinitialize_replay(replay);
+                        return false;
+                }
+
+                input_count += delta;
+                if (delta == 0ULL || input_count > code_count) {
+                        send_message(MESSAGE_ERROR, "Failed to read replay \"%s\": Seek point %zu is out of order", path, seek_point_index);
+                        deinitialize_replay(replay);
+                        return false;
+                }
+
+                add_replay_seek_point(replay, (uint32_t)input_count, state_hash);
+        }
+
+        return true;
+}
+
+bool read_replay(struct Replay *const replay, const char *const path) {
+        FILE *const file = fopen(path, "rb");
+        if (file == NULL) {
+                send_message(MESSAGE_ERROR, "Failed to read replay \"%s\": %s", path, strerror(errno));
+                return false;
+        }
+
+        fseek(file, 0L, SEEK_END);
+        const long size = ftell(file);
+        rewind(file);
+
+        struct ReplayBuffer buffer = {0};
+        buffer.size = size > 0L ? (size_t)size : 0ULL;
+        buffer.bytes = (uint8_t *)xmalloc(MAXIMUM_VALUE(buffer.size, 1ULL));
+
+        if (fread(buffer.bytes, 1ULL, buffer.size, file) != buffer.size) {
+                send_message(MESSAGE_ERROR, "Failed to read replay \"%s\": %s", path, strerror(errno));
+                xfree(buffer.bytes);
+                fclose(file);
+                return false;
+        }
+
+        fclose(file);
+
+        const bool parsed = parse_replay(replay, &buffer, path);
+        xfree(buffer.bytes);
+        return parsed;
+}
+
+// ================================================================================================
+// Verification
+// ================================================================================================
+
+void initialize_replay_verifier(struct ReplayVerifier *const verifier, const struct LevelState *const state, const size_t maximum_depth, const bool compact) {
+        copy_level_state(state, &verifier->state);
+        initialize_step_history(&verifier->step_history, state, maximum_depth, (compact ? STEP_HISTORY_FLAG_COMPACT : 0) | STEP_HISTORY_FLAG_TRAIL);
+        verifier->initial_entities = (struct EntityState *)xmalloc(MAXIMUM_VALUE((size_t)state->entity_count, 1ULL) * sizeof(struct EntityState));
+        save_level_state(state, verifier->initial_entities, &verifier->initial_player_index);
+        verifier->level_hash = hash_replay_level(state);
+        verifier->change_buffer = (struct Change *)xmalloc(get_level_state_change_limit(state) * sizeof(struct Change));
+        verifier->switch_anchor_player_index = ENTITY_INDEX_NONE;
+}
+
+void deinitialize_replay_verifier(struct ReplayVerifier *const verifier) {
+        xfree(verifier->change_buffer);
+        xfree(verifier->initial_entities);
+        deinitialize_step_history(&verifier->step_history);
+        deinitialize_level_state(&verifier->state);
+}
+
+void restart_replay_verifier(struct ReplayVerifier *const verifier) {
+        restart_step_history(&verifier->step_history, &verifier->state, verifier->initial_entities, verifier->initial_player_index, &verifier->switch_anchor_player_index);
+}
+
+bool play_replay_code(struct ReplayVerifier *const verifier, const uint8_t code) {
+        if (code == REPLAY_CODE_RESTART) {
+                restart_replay_verifier(verifier);
+                return true;
+        }
+
+        struct StepOutcome outcome;
+        step_history_play_input(&verifier->step_history, &verifier->state, &verifier->switch_anchor_player_index, (enum Input)code, ENTITY_INDEX_NONE, verifier->change_buffer, &outcome);
+        return outcome.changed || outcome.ending_switches;
+}
+
+bool verify_replay(struct ReplayVerifier *const verifier, const struct Replay *const replay, struct ReplayVerification *const out_verification) {
+        *out_verification = (struct ReplayVerification){0};
+
+        if (replay->level_hash != verifier->level_hash) {
+                out_verification->divergence = REPLAY_DIVERGENCE_LEVEL;
+                return false;
+        }
+
+        restart_replay_verifier(verifier);
+        clear_step_history_trail(&verifier->step_history);
+
+        size_t seek_point_index = 0ULL;
+        for (size_t code_index = 0ULL; code_index < replay->code_count; ++code_index) {
+                if (!play_replay_code(verifier, replay->codes[code_index])) {
+                        out_verification->divergence = REPLAY_DIVERGENCE_INPUT;
+                        out_verification->input_index = code_index;
+                        return false;
+                }
+
+                if (!out_verification->won && is_level_state_won(&verifier->state)) {
+                        out_verification->won = true;
+                        out_verification->won_input_index = code_index;
+                        out_verification->won_move_count = verifier->step_history.move_count;
+                }
+
+                if (seek_point_index < replay->seek_point_count && replay->seek_points[seek_point_index].input_count == code_index + 1ULL) {
+                        if (replay->seek_points[seek_point_index].state_hash != hash_level_state(&verifier->state)) {
+                                out_verification->divergence = REPLAY_DIVERGENCE_STATE;
+                                out_verification->input_index = code_index;
+                                return false;
+                        }
+
+                        out_verification->matched_input_count = code_index + 1ULL;
+                        ++seek_point_index;
+                }
+        }
+
+        if (replay->final_state_hash != hash_level_state(&verifier->state)) {
+                out_verification->divergence = REPLAY_DIVERGENCE_STATE;
+                out_verification->input_index = replay->code_count > 0ULL ? replay->code_count - 1ULL : 0ULL;
+                return false;
+        }
+
+        out_verification->matched_input_count = replay->code_count;
+        return true;
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "State.h"
+#include "History.h"
+
+// A replay is every input of a play session that changed the level, in the order the level processed them. Inputs
+// that had no effect, like walking into a wall, are left out unless they ended a run of switches, so an input that
+// does nothing when the replay is played back is a divergence at that exact input. Restarting the level is kept as an
+// input of its own and jumping through the history is kept as the undos or redos that end up at the same step.
+//
+// Besides the inputs, a replay keeps the number and a hash of the level it was recorded on, optionally the time of
+// every input and a seek point every 'REPLAY_SEEK_INTERVAL' inputs with the hash of the level state at that point. The
+// seek points only narrow down where a replay that ends up somewhere else went wrong. They keep no level state to
+// resume from, so checking any stretch of a replay still plays every input before it.
+//
+// The file is little endian: a header with the magic "SBRP", the version, the flags, the level number and hash, the
+// input count, the seek point count, the hash of the final state and the seek interval, then the inputs packed two to
+// a byte, then the times as varints of the milliseconds since the input before and then the seek points as the varint
+// of the inputs since the one before and the state hash
+
+#define REPLAY_SEEK_INTERVAL 32ULL
+
+// Stored in the place of an input, since the inputs only take up the lower half of a nibble
+#define REPLAY_CODE_RESTART 8U
+
+struct ReplaySeekPoint {
+        uint32_t input_count; // The state hash is the one after this many inputs
+        uint64_t state_hash;
+};
+
+struct Replay {
+        uint16_t level_number;
+        uint64_t level_hash;
+        bool timed;
+        uint8_t *codes;
+        uint32_t *times; // Milliseconds since the recording started, only kept for timed replays
+        size_t code_count;
+        size_t code_capacity;
+        struct ReplaySeekPoint *seek_points;
+        size_t seek_point_count;
+        size_t seek_point_capacity;
+        uint64_t final_state_hash;
+};
+
+// The level state has to be the one that was just loaded, since that is what the level hash is taken from
+void initialize_replay(struct Replay *const replay, const uint16_t level_number, const struct LevelState *const state, const bool timed);
+
+void deinitialize_replay(struct Replay *const replay);
+
+// Hashes the tiles, the joints and where the entities start out, which tells apart two versions of the same level
+uint64_t hash_replay_level(const struct LevelState *const state);
+
+// The state hash is the one after the input was processed the given number of times, repeating an input is how a
+// switch straight to some player or a jump through the history gets recorded
+void record_replay_input(struct Replay *const replay, const enum Input input, const size_t repeat_count, const uint32_t time, const uint64_t state_hash);
+
+void record_replay_restart(struct Replay *const replay, const uint32_t time, const uint64_t state_hash);
+
+bool write_replay(const struct Replay *const replay, const char *const path);
+
+// Initializes the replay from the file, the replay only has to be deinitialized if this succeeds
+bool read_replay(struct Replay *const replay, const char *const path);
+
+enum ReplayDivergence {
+        REPLAY_DIVERGENCE_NONE,
+        REPLAY_DIVERGENCE_LEVEL,  // The level isn't the one the replay was recorded on
+        REPLAY_DIVERGENCE_INPUT,  // The input had no effect
+        REPLAY_DIVERGENCE_STATE   // The state after the input doesn't match its seek point or the final state
+};
+
+struct ReplayVerification {
+        enum ReplayDivergence divergence;
+        size_t input_index;         // The input that diverged
+        size_t matched_input_count; // How many inputs are known to end up where they did when recording
+        bool won;
+        size_t won_input_index;     // The input that first won the level
+        size_t won_move_count;
+};
+
+// Plays replays back with the same step rules as the level: turns in a row are merged into one step and so are
+// switches in a row, and undoing and redoing go through a step history of their own. Everything is allocated once
+// for the level, so a verifier can go through any number of replays of the same level
+struct ReplayVerifier {
+        struct LevelState state;
+        struct StepHistory step_history;
+        struct EntityState *initial_entities;
+        uint16_t initial_player_index;
+        uint64_t level_hash;
+        struct Change *change_buffer;
+        uint16_t switch_anchor_player_index;
+};
+
+// The level state has to be the one that was just loaded and is copied, so it can be deinitialized right after. Replays
+// play back the same with any depth and either kind of step history as long as no step gets evicted, the level itself
+// keeps 'STEP_HISTORY_MAXIMUM_DEPTH' steps
+void initialize_replay_verifier(struct ReplayVerifier *const verifier, const struct LevelState *const state, const size_t maximum_depth, const bool compact);
+
+void deinitialize_replay_verifier(struct ReplayVerifier *const verifier);
+
+// Puts the level back to how it was loaded and forgets every step, like restarting the level does
+void restart_replay_verifier(struct ReplayVerifier *const verifier);
+
+// Plays a single input or 'REPLAY_CODE_RESTART' back the way the level processes it. Returns false if the input had no
+// effect and didn't end a run of switches either
+bool play_replay_code(struct ReplayVerifier *const verifier, const uint8_t code);
+
+// Returns true if the replay plays back exactly like it was recorded, whether it also won the level is in the
+// verification either way. The trail of the step history is cleared first, so afterwards it holds the steps of this
+// replay to compare against the trail of the session it was recorded in
+bool verify_replay(struct ReplayVerifier *const verifier, const struct Replay *const replay, struct ReplayVerification *const out_verification);
\ No newline at end of file
@@ -0,0 +1,1245 @@
+#include "Solver.h"
+
+#include <time.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "Assignment.h"
+#include "Bitboard.h"
+#include "Hexagons.h"
+#include "State.h"
+#include "Threads.h"
+#include "Memory.h"
+#include "Defines.h"
+#include "Debug.h"
+
+#define SOLVER_DISTANCE_NONE UINT16_MAX
+#define SOLVER_ESTIMATE_NONE UINT32_MAX
+#define SOLVER_CHUNK_NODE_COUNT 4096ULL
+#define SOLVER_STEAL_LIMIT 64ULL
+#define SOLVER_CACHE_INITIAL_CAPACITY 256ULL
+
+// Stands in for a block that can't reach a spot, it is big enough that no assignment with it beats one without it
+#define SOLVER_COST_UNREACHABLE ((int32_t)1 << 20)
+
+// The push that led to a node is kept instead of its inputs, the inputs are only worked out for the solution. The
+// lock guards the cost together with the push, since another thread can find a cheaper way to the node at any time
+struct SolverNode {
+        struct SolverNode *parent;
+        uint64_t hash;
+        atomic_flag lock;
+        uint32_t cost;
+        uint16_t pusher_index;
+        uint16_t push_tile_index;
+        uint8_t push_direction;
+        uint16_t tiles[];
+};
+
+struct SolverOpenEntry {
+        uint32_t estimate;
+        uint32_t cost;
+        struct SolverNode *node;
+};
+
+// Every thread has an open list of its own, a thread that runs out of nodes steals the best ones of another thread
+struct SolverOpenList {
+        struct Mutex mutex;
+        struct SolverOpenEntry *entries;
+        size_t count;
+        size_t capacity;
+};
+
+struct Solver;
+struct SolverWorker {
+        struct Solver *solver;
+        struct Thread thread;
+        struct LevelState *state;
+        struct LevelState own_state;
+        struct EntityState *scratch_entities;
+        uint16_t *walk_distances;
+        uint16_t *walk_parents;
+        uint16_t *walk_queue;
+        struct Change *change_buffer;
+        uint16_t *tiles;
+        struct SolverOpenList open_list;
+
+        // The assignment of the node that is being expanded, most of its successors only move a single block and
+        // are checked against it before solving their own assignment
+        struct Assignment assignment;
+        struct Assignment next_assignment;
+        int32_t *costs;
+        int32_t *next_costs;
+        int32_t *column_costs;
+
+        // Nodes are handed out from chunks that never move, so that other threads can keep pointers to them
+        uint8_t **chunks;
+        size_t chunk_count;
+        size_t chunk_capacity;
+        size_t chunk_node_count;
+        struct SolverNode *spare_node;
+
+        size_t expanded_node_count;
+        size_t generated_node_count;
+};
+
+struct Solver {
+        const struct LevelState *state;
+        struct EntityState *start_entities;
+        uint16_t start_player_index;
+        uint16_t block_count;
+        uint16_t *block_indices;
+        uint16_t *neighbors;
+
+        // 'floor_distances[spot * tile_count + tile]' is how many pushes a joined block on the tile is away from the
+        // spot, and 'push_distances' is the same for loose blocks, which also need something behind them to push them
+        uint16_t *floor_distances;
+        uint16_t *push_distances;
+
+        // The most blocks that a single move can push, which is what the sum of the assigned distances is divided by
+        uint16_t push_block_limit;
+        struct Bitboard dead_tiles;
+        struct Bitboard joined_dead_tiles;
+
+        // The transposition table never grows, it is made big enough for the node limit up front so that inserting
+        // only takes a compare and swap on the slot
+        size_t node_stride;
+        size_t node_limit;
+        _Atomic(struct SolverNode *) *table;
+        size_t table_capacity;
+        atomic_size_t node_count;
+
+        // Counts the open entries together with the ones being expanded, the search is over once it hits zero
+        atomic_size_t pending_count;
+        atomic_bool stopped;
+        const atomic_bool *cancelled;
+        struct SolverCache *cache;
+
+        atomic_uint_least32_t best_cost;
+        struct SolverNode *goal_node;
+        struct Mutex goal_mutex;
+
+        struct SolverWorker *workers;
+        size_t worker_count;
+};
+
+static inline double get_solver_seconds(void) {
+        struct timespec time;
+        timespec_get(&time, TIME_UTC);
+        return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+static inline uint16_t get_solver_neighbor(const struct Solver *const solver, const uint16_t tile_index, const enum Orientation direction) {
+        return solver->neighbors[tile_index * ORIENTATION_COUNT + direction];
+}
+
+static inline uint64_t hash_solver_tiles(const uint16_t *const tiles, const uint16_t entity_count) {
+        uint64_t hash = 0x9E3779B97F4A7C15ULL;
+        for (uint16_t entity_index = 0; entity_index < entity_count; ++entity_index) {
+                hash = (hash ^ tiles[entity_index]) * 0xBF58476D1CE4E5B9ULL;
+                hash ^= hash >> 31;
+        }
+
+        return hash;
+}
+
+// Nothing is added to the cache while searching, so the threads can look things up in it without any locking
+static const struct SolverCacheEntry *find_solver_cache_entry(const struct SolverCache *const cache, const uint16_t *const tiles) {
+        const uint64_t hash = hash_solver_tiles(tiles, cache->entity_count);
+
+        for (size_t slot = hash & (cache->capacity - 1ULL); cache->entries[slot].used; slot = (slot + 1ULL) & (cache->capacity - 1ULL)) {
+                const struct SolverCacheEntry *const entry = &cache->entries[slot];
+                if (entry->hash == hash && memcmp(&cache->tiles[slot * cache->entity_count], tiles, cache->entity_count * sizeof(uint16_t)) == 0) {
+                        return entry;
+                }
+        }
+
+        return NULL;
+}
+
+static void add_solver_cache_entry(struct SolverCache *const cache, const uint16_t *const tiles, const struct SolverCacheEntry *const entry) {
+        if (find_solver_cache_entry(cache, tiles) != NULL) {
+                return;
+        }
+
+        // The cache is kept at most half full so that looking up a state that isn't in it stops early
+        if ((cache->count + 1ULL) * 2ULL > cache->capacity) {
+                const size_t last_capacity = cache->capacity;
+                struct SolverCacheEntry *const last_entries = cache->entries;
+                uint16_t *const last_tiles = cache->tiles;
+
+                cache->capacity *= 2ULL;
+                cache->count = 0ULL;
+                cache->entries = (struct SolverCacheEntry *)xcalloc(cache->capacity, sizeof(struct SolverCacheEntry));
+                cache->tiles = (uint16_t *)xmalloc(cache->capacity * MAXIMUM_VALUE((size_t)cache->entity_count, 1ULL) * sizeof(uint16_t));
+
+                for (size_t slot = 0ULL; slot < last_capacity; ++slot) {
+                        if (last_entries[slot].used) {
+                                add_solver_cache_entry(cache, &last_tiles[slot * cache->entity_count], &last_entries[slot]);
+                        }
+                }
+
+                xfree(last_tiles);
+                xfree(last_entries);
+        }
+
+        const uint64_t hash = hash_solver_tiles(tiles, cache->entity_count);
+
+        size_t slot = hash & (cache->capacity - 1ULL);
+        while (cache->entries[slot].used) {
+                slot = (slot + 1ULL) & (cache->capacity - 1ULL);
+        }
+
+        cache->entries[slot] = *entry;
+        cache->entries[slot].hash = hash;
+        cache->entries[slot].used = true;
+        memcpy(&cache->tiles[slot * cache->entity_count], tiles, cache->entity_count * sizeof(uint16_t));
+        ++cache->count;
+}
+
+static inline bool is_solver_stopped(const struct Solver *const solver) {
+        return atomic_load_explicit(&solver->stopped, memory_order_relaxed) || (solver->cancelled != NULL && atomic_load_explicit(solver->cancelled, memory_order_relaxed));
+}
+
+static inline void lock_solver_node(struct SolverNode *const node) {
+        while (atomic_flag_test_and_set_explicit(&node->lock, memory_order_acquire)) {
+                continue;
+        }
+}
+
+static inline void unlock_solver_node(struct SolverNode *const node) {
+        atomic_flag_clear_explicit(&node->lock, memory_order_release);
+}
+
+static void initialize_solver_worker(struct Solver *const solver, struct SolverWorker *const worker, struct LevelState *const state) {
+        *worker = (struct SolverWorker){0};
+        worker->solver = solver;
+
+        // The first worker runs on the calling thread and works on the given level state, the others get a copy
+        if (state != NULL) {
+                worker->state = state;
+        } else {
+                copy_level_state(solver->state, &worker->own_state);
+                worker->state = &worker->own_state;
+        }
+
+        const uint16_t tile_count = solver->state->tile_count;
+        worker->scratch_entities = (struct EntityState *)xmalloc(MAXIMUM_VALUE((size_t)solver->state->entity_count, 1ULL) * sizeof(struct EntityState));
+        worker->walk_distances = (uint16_t *)xmalloc(tile_count * sizeof(uint16_t));
+        worker->walk_parents = (uint16_t *)xmalloc(tile_count * sizeof(uint16_t));
+        worker->walk_queue = (uint16_t *)xmalloc(tile_count * sizeof(uint16_t));
+        worker->change_buffer = (struct Change *)xmalloc(get_level_state_change_limit(solver->state) * sizeof(struct Change));
+        worker->tiles = (uint16_t *)xmalloc(MAXIMUM_VALUE((size_t)solver->state->entity_count, 1ULL) * sizeof(uint16_t));
+
+        const uint16_t row_count = MINIMUM_VALUE(solver->state->spot_count, solver->block_count);
+        initialize_assignment(&worker->assignment, row_count, solver->block_count);
+        initialize_assignment(&worker->next_assignment, row_count, solver->block_count);
+        worker->costs = (int32_t *)xmalloc(MAXIMUM_VALUE((size_t)row_count * solver->block_count, 1ULL) * sizeof(int32_t));
+        worker->next_costs = (int32_t *)xmalloc(MAXIMUM_VALUE((size_t)row_count * solver->block_count, 1ULL) * sizeof(int32_t));
+        worker->column_costs = (int32_t *)xmalloc(((size_t)row_count + 1ULL) * sizeof(int32_t));
+
+        initialize_mutex(&worker->open_list.mutex);
+        worker->open_list.capacity = 1024ULL;
+        worker->open_list.entries = (struct SolverOpenEntry *)xmalloc(worker->open_list.capacity * sizeof(struct SolverOpenEntry));
+}
+
+static void deinitialize_solver_worker(struct SolverWorker *const worker) {
+        for (size_t chunk_index = 0ULL; chunk_index < worker->chunk_count; ++chunk_index) {
+                xfree(worker->chunks[chunk_index]);
+        }
+
+        if (worker->chunks != NULL) {
+                xfree(worker->chunks);
+        }
+
+        xfree(worker->open_list.entries);
+        deinitialize_mutex(&worker->open_list.mutex);
+
+        xfree(worker->column_costs);
+        xfree(worker->next_costs);
+        xfree(worker->costs);
+        deinitialize_assignment(&worker->next_assignment);
+        deinitialize_assignment(&worker->assignment);
+
+        xfree(worker->tiles);
+        xfree(worker->change_buffer);
+        xfree(worker->walk_queue);
+        xfree(worker->walk_parents);
+        xfree(worker->walk_distances);
+        xfree(worker->scratch_entities);
+
+        if (worker->state == &worker->own_state) {
+                deinitialize_level_state(&worker->own_state);
+        }
+}
+
+static inline bool is_solver_block_floor(const struct Solver *const solver, const uint16_t tile_index) {
+        return tile_index != SOLVER_DISTANCE_NONE && (solver->state->tiles[tile_index] == TILE_CELL || solver->state->tiles[tile_index] == TILE_SPOT);
+}
+
+// Works out how many pushes a block needs to get from every tile to the spot by going backwards from the spot. With
+// pushing, a block can only come from a tile that has something behind it, which takes a tile that isn't empty.
+// Joined blocks get moved along by the rest of their group, so for them only the floor matters
+static void measure_solver_distances(const struct Solver *const solver, const uint16_t spot_tile_index, const bool pushing, uint16_t *const queue, uint16_t *const out_distances) {
+        const struct LevelState *const state = solver->state;
+
+        for (uint16_t tile_index = 0; tile_index < state->tile_count; ++tile_index) {
+                out_distances[tile_index] = SOLVER_DISTANCE_NONE;
+        }
+
+        size_t queue_head = 0ULL;
+        size_t queue_tail = 0ULL;
+        out_distances[spot_tile_index] = 0;
+        queue[queue_tail++] = spot_tile_index;
+
+        while (queue_head < queue_tail) {
+                const uint16_t tile_index = queue[queue_head++];
+                for (int direction = 0; direction < ORIENTATION_COUNT; ++direction) {
+                        const uint16_t neighbor_index = get_solver_neighbor(solver, tile_index, (enum Orientation)direction);
+                        if (!is_solver_block_floor(solver, neighbor_index) || out_distances[neighbor_index] != SOLVER_DISTANCE_NONE) {
+                                continue;
+                        }
+
+                        if (pushing) {
+                                const uint16_t pusher_index = get_solver_neighbor(solver, neighbor_index, (enum Orientation)direction);
+                                if (pusher_index == SOLVER_DISTANCE_NONE || state->tiles[pusher_index] == TILE_EMPTY) {
+                                        continue;
+                                }
+                        }
+
+                        out_distances[neighbor_index] = (uint16_t)(out_distances[tile_index] + 1);
+                        queue[queue_tail++] = neighbor_index;
+                }
+        }
+}
+
+// Pushing a line of blocks moves every one of them, and the line needs one more tile of floor in front of it. Joined
+// blocks can move all at once, so any joint leaves only the block count as the limit
+static uint16_t measure_solver_push_block_limit(const struct Solver *const solver) {
+        const struct LevelState *const state = solver->state;
+
+        if (solver->block_count <= 1) {
+                return 1;
+        }
+
+        for (uint16_t block_index = 0; block_index < solver->block_count; ++block_index) {
+                if (state->group_indices[solver->block_indices[block_index]] != GROUP_INDEX_NONE) {
+                        return solver->block_count;
+                }
+        }
+
+        int longest_length = 0;
+
+        for (uint16_t tile_index = 0; tile_index < state->tile_count; ++tile_index) {
+                for (int direction = 0; direction < ORIENTATION_COUNT; ++direction) {
+                        int length = 0;
+                        for (uint16_t line_index = tile_index; is_solver_block_floor(solver, line_index); line_index = get_solver_neighbor(solver, line_index, (enum Orientation)direction)) {
+                                ++length;
+                        }
+
+                        longest_length = MAXIMUM_VALUE(longest_length, length);
+                }
+        }
+
+        return (uint16_t)CLAMPED_VALUE(longest_length - 1, 1, (int)solver->block_count);
+}
+
+static void initialize_solver(
+        struct Solver *const solver,
+        struct LevelState *const state,
+        const size_t thread_count,
+        const size_t node_limit,
+        struct SolverCache *const cache,
+        const atomic_bool *const cancelled
+) {
+        *solver = (struct Solver){0};
+        solver->state = state;
+        solver->cache = cache;
+        solver->cancelled = cancelled;
+
+        const uint16_t tile_count = state->tile_count;
+        const uint16_t entity_count = state->entity_count;
+
+        solver->start_entities = (struct EntityState *)xmalloc(MAXIMUM_VALUE((size_t)entity_count, 1ULL) * sizeof(struct EntityState));
+        save_level_state(state, solver->start_entities, &solver->start_player_index);
+
+        solver->block_indices = (uint16_t *)xmalloc(MAXIMUM_VALUE((size_t)entity_count, 1ULL) * sizeof(uint16_t));
+        for (uint16_t entity_index = 0; entity_index < entity_count; ++entity_index) {
+                if (state->entities[entity_index].type == ENTITY_BLOCK) {
+                        solver->block_indices[solver->block_count++] = entity_index;
+                }
+        }
+
+        solver->neighbors = (uint16_t *)xmalloc(tile_count * ORIENTATION_COUNT * sizeof(uint16_t));
+        for (uint8_t row = 0; row < state->rows; ++row) {
+                for (uint8_t column = 0; column < state->columns; ++column) {
+                        const uint16_t tile_index = (uint16_t)(row * state->columns + column);
+
+                        for (int direction = 0; direction < ORIENTATION_COUNT; ++direction) {
+                                size_t neighbor_column, neighbor_row;
+                                solver->neighbors[tile_index * ORIENTATION_COUNT + direction] =
+                                        orientation_advance((enum Orientation)direction, column, row, state->columns, state->rows, &neighbor_column, &neighbor_row)
+                                        ? (uint16_t)(neighbor_row * state->columns + neighbor_column)
+                                        : SOLVER_DISTANCE_NONE;
+                        }
+                }
+        }
+
+        const size_t distance_count = MAXIMUM_VALUE((size_t)state->spot_count * tile_count, 1ULL);
+        solver->floor_distances = (uint16_t *)xmalloc(distance_count * sizeof(uint16_t));
+        solver->push_distances = (uint16_t *)xmalloc(distance_count * sizeof(uint16_t));
+        uint16_t *const queue = (uint16_t *)xmalloc(tile_count * sizeof(uint16_t));
+
+        uint16_t spot_index = 0;
+        for (uint16_t spot_tile_index = 0; spot_tile_index < tile_count; ++spot_tile_index) {
+                if (state->tiles[spot_tile_index] == TILE_SPOT) {
+                        measure_solver_distances(solver, spot_tile_index, false, queue, &solver->floor_distances[(size_t)spot_index * tile_count]);
+                        measure_solver_distances(solver, spot_tile_index, true, queue, &solver->push_distances[(size_t)spot_index * tile_count]);
+                        ++spot_index;
+                }
+        }
+
+        xfree(queue);
+        solver->push_block_limit = measure_solver_push_block_limit(solver);
+
+        struct LevelBitboards bitboards;
+        populate_level_bitboards(&bitboards, state);
+        query_level_bitboards_dead_tiles(&bitboards, &solver->dead_tiles, &solver->joined_dead_tiles);
+
+        // The nodes are laid out back to back in the chunks, so the stride keeps the next node aligned
+        const size_t alignment = _Alignof(struct SolverNode);
+        solver->node_stride = (sizeof(struct SolverNode) + entity_count * sizeof(uint16_t) + alignment - 1ULL) / alignment * alignment;
+        solver->node_limit = node_limit;
+
+        // Every thread can add one node past the limit before it notices, the table is kept at most about half full
+        solver->table_capacity = 1024ULL;
+        while (solver->table_capacity < MAXIMUM_VALUE(node_limit, thread_count) * 2ULL) {
+                solver->table_capacity *= 2ULL;
+        }
+
+        solver->table = (_Atomic(struct SolverNode *) *)xcalloc(solver->table_capacity, sizeof(_Atomic(struct SolverNode *)));
+        atomic_init(&solver->node_count, 0ULL);
+        atomic_init(&solver->pending_count, 0ULL);
+        atomic_init(&solver->stopped, false);
+        atomic_init(&solver->best_cost, SOLVER_ESTIMATE_NONE);
+        initialize_mutex(&solver->goal_mutex);
+
+        solver->worker_count = thread_count;
+        solver->workers = (struct SolverWorker *)xmalloc(thread_count * sizeof(struct SolverWorker));
+        for (size_t worker_index = 0ULL; worker_index < thread_count; ++worker_index) {
+                initialize_solver_worker(solver, &solver->workers[worker_index], worker_index == 0ULL ? state : NULL);
+        }
+}
+
+static void deinitialize_solver(struct Solver *const solver) {
+        restore_level_state(solver->workers[0].state, solver->start_entities, solver->start_player_index);
+
+        for (size_t worker_index = 0ULL; worker_index < solver->worker_count; ++worker_index) {
+                deinitialize_solver_worker(&solver->workers[worker_index]);
+        }
+
+        xfree(solver->workers);
+        deinitialize_mutex(&solver->goal_mutex);
+        xfree(solver->table);
+        xfree(solver->push_distances);
+        xfree(solver->floor_distances);
+        xfree(solver->block_indices);
+        xfree(solver->neighbors);
+        xfree(solver->start_entities);
+}
+
+static size_t get_solver_memory(const struct Solver *const solver) {
+        const size_t tile_count = solver->state->tile_count;
+        const size_t entity_count = solver->state->entity_count;
+
+        size_t memory_bytes =
+                entity_count * sizeof(struct EntityState) +
+                tile_count * ORIENTATION_COUNT * sizeof(uint16_t) +
+                (size_t)solver->state->spot_count * tile_count * 2ULL * sizeof(uint16_t) +
+                (size_t)solver->block_count * sizeof(uint16_t) +
+                solver->table_capacity * sizeof(struct SolverNode *);
+
+        for (size_t worker_index = 0ULL; worker_index < solver->worker_count; ++worker_index) {
+                const struct SolverWorker *const worker = &solver->workers[worker_index];
+                memory_bytes +=
+                        entity_count * (sizeof(struct EntityState) + sizeof(uint16_t)) +
+                        tile_count * 3ULL * sizeof(uint16_t) +
+                        get_level_state_change_limit(solver->state) * sizeof(struct Change) +
+                        worker->open_list.capacity * sizeof(struct SolverOpenEntry) +
+                        ((size_t)worker->assignment.row_count * solver->block_count * 2ULL + worker->assignment.row_count) * sizeof(int32_t) +
+                        ((size_t)worker->assignment.row_count + solver->block_count) * 2ULL * (sizeof(int32_t) * 3ULL + sizeof(uint16_t) * 2ULL) +
+                        worker->chunk_count * SOLVER_CHUNK_NODE_COUNT * solver->node_stride;
+
+                // The copied level states
+                if (worker_index > 0ULL) {
+                        memory_bytes +=
+                                tile_count * (sizeof(enum TileType) + sizeof(uint16_t)) +
+                                entity_count * (sizeof(struct EntityState) + sizeof(uint16_t) * 4ULL);
+                }
+        }
+
+        return memory_bytes;
+}
+
+static inline void read_solver_tiles(const struct LevelState *const state, uint16_t *const out_tiles) {
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                const struct EntityState *const entity = &state->entities[entity_index];
+                out_tiles[entity_index] = (uint16_t)(entity->row * state->columns + entity->column);
+        }
+}
+
+// Puts the entities where the node has them, optionally with one player moved to the given tile and direction
+static void load_solver_node(struct SolverWorker *const worker, const struct SolverNode *const node, const uint16_t player_index, const uint16_t tile_index, const enum Orientation direction) {
+        const struct Solver *const solver = worker->solver;
+        struct LevelState *const state = worker->state;
+
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                struct EntityState *const entity = &worker->scratch_entities[entity_index];
+                *entity = solver->start_entities[entity_index];
+                entity->column = (uint8_t)(node->tiles[entity_index] % state->columns);
+                entity->row = (uint8_t)(node->tiles[entity_index] / state->columns);
+        }
+
+        if (player_index != ENTITY_INDEX_NONE) {
+                struct EntityState *const player = &worker->scratch_entities[player_index];
+                player->column = (uint8_t)(tile_index % state->columns);
+                player->row = (uint8_t)(tile_index / state->columns);
+                player->orientation = (uint8_t)direction;
+        }
+
+        restore_level_state(state, worker->scratch_entities, player_index == ENTITY_INDEX_NONE ? solver->start_player_index : player_index);
+}
+
+static bool is_solver_deadlocked(const struct Solver *const solver, const uint16_t *const tiles) {
+        const struct LevelState *const state = solver->state;
+
+        uint16_t dead_block_count = 0;
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                if (solver->start_entities[entity_index].type != ENTITY_BLOCK) {
+                        continue;
+                }
+
+                const struct Bitboard *const dead_tiles = state->group_indices[entity_index] == GROUP_INDEX_NONE ? &solver->dead_tiles : &solver->joined_dead_tiles;
+                if (bitboard_test(dead_tiles, tiles[entity_index])) {
+                        ++dead_block_count;
+                }
+        }
+
+        return solver->block_count - dead_block_count < state->spot_count;
+}
+
+static inline int32_t get_solver_cost(const struct Solver *const solver, const uint16_t spot_index, const uint16_t block_index, const uint16_t tile_index) {
+        const uint16_t *const distances = solver->state->group_indices[solver->block_indices[block_index]] == GROUP_INDEX_NONE ? solver->push_distances : solver->floor_distances;
+        const uint16_t distance = distances[(size_t)spot_index * solver->state->tile_count + tile_index];
+        return distance == SOLVER_DISTANCE_NONE ? SOLVER_COST_UNREACHABLE : (int32_t)distance;
+}
+
+// Rows are the spots and columns are the blocks
+static void fill_solver_costs(const struct Solver *const solver, const uint16_t *const tiles, int32_t *const out_costs) {
+        for (uint16_t spot_index = 0; spot_index < solver->state->spot_count; ++spot_index) {
+                for (uint16_t block_index = 0; block_index < solver->block_count; ++block_index) {
+                        out_costs[(size_t)spot_index * solver->block_count + block_index] = get_solver_cost(solver, spot_index, block_index, tiles[solver->block_indices[block_index]]);
+                }
+        }
+}
+
+// Every spot needs a block of its own, so the cheapest assignment of blocks to spots is a lower bound for the pushes
+// of a single block at a time. A move can push a whole line of blocks though, so the sum gets divided by the most
+// blocks a move can push. Every block also moves by a tile per move at most, which makes the spot that is the furthest
+// from its closest block another lower bound. Zero means that every spot is covered
+static uint32_t estimate_solver_cost(const struct Solver *const solver, const int32_t *const costs, const int32_t total_cost) {
+        if (solver->state->spot_count > solver->block_count || total_cost >= SOLVER_COST_UNREACHABLE) {
+                return SOLVER_ESTIMATE_NONE;
+        }
+
+        uint32_t estimate = ((uint32_t)total_cost + solver->push_block_limit - 1U) / solver->push_block_limit;
+        for (uint16_t spot_index = 0; spot_index < solver->state->spot_count; ++spot_index) {
+                int32_t closest_cost = SOLVER_COST_UNREACHABLE;
+                for (uint16_t block_index = 0; block_index < solver->block_count; ++block_index) {
+                        closest_cost = MINIMUM_VALUE(closest_cost, costs[(size_t)spot_index * solver->block_count + block_index]);
+                }
+
+                estimate = MAXIMUM_VALUE(estimate, (uint32_t)closest_cost);
+        }
+
+        return estimate;
+}
+
+// Estimates the cost of a successor of the node whose assignment the worker holds. When only a single block moved,
+// the assignment of the node often stays the cheapest one and doesn't have to be solved again
+static uint32_t estimate_solver_successor_cost(struct SolverWorker *const worker, const struct SolverNode *const node, const uint16_t *const tiles) {
+        const struct Solver *const solver = worker->solver;
+        const uint16_t spot_count = solver->state->spot_count;
+
+        if (spot_count > solver->block_count) {
+                return SOLVER_ESTIMATE_NONE;
+        }
+
+        uint16_t moved_block_index = UINT16_MAX;
+        uint16_t moved_block_count = 0;
+        for (uint16_t block_index = 0; block_index < solver->block_count; ++block_index) {
+                const uint16_t entity_index = solver->block_indices[block_index];
+                if (tiles[entity_index] != node->tiles[entity_index]) {
+                        moved_block_index = block_index;
+                        ++moved_block_count;
+                }
+        }
+
+        memcpy(worker->next_costs, worker->costs, (size_t)spot_count * solver->block_count * sizeof(int32_t));
+
+        if (moved_block_count == 1) {
+                int32_t *const column_costs = worker->column_costs;
+                for (uint16_t spot_index = 0; spot_index < spot_count; ++spot_index) {
+                        column_costs[spot_index] = get_solver_cost(solver, spot_index, moved_block_index, tiles[solver->block_indices[moved_block_index]]);
+                        worker->next_costs[(size_t)spot_index * solver->block_count + moved_block_index] = column_costs[spot_index];
+                }
+
+                int32_t total_cost;
+                if (query_assignment_column_change(&worker->assignment, worker->costs, moved_block_index, column_costs, &total_cost)) {
+                        return estimate_solver_cost(solver, worker->next_costs, total_cost);
+                }
+        } else if (moved_block_count > 1) {
+                fill_solver_costs(solver, tiles, worker->next_costs);
+        }
+
+        return estimate_solver_cost(solver, worker->next_costs, solve_assignment(&worker->next_assignment, worker->next_costs));
+}
+
+// Ties go to the deeper entry, which is usually closer to the goal
+static inline bool solver_entry_precedes(const struct SolverOpenEntry *const a, const struct SolverOpenEntry *const b) {
+        return a->estimate < b->estimate || (a->estimate == b->estimate && a->cost > b->cost);
+}
+
+static void push_solver_open_list(struct SolverOpenList *const open_list, const struct SolverOpenEntry entry) {
+        if (open_list->count == open_list->capacity) {
+                open_list->capacity *= 2ULL;
+                open_list->entries = (struct SolverOpenEntry *)xrealloc(open_list->entries, open_list->capacity * sizeof(struct SolverOpenEntry));
+        }
+
+        size_t index = open_list->count++;
+        while (index > 0ULL) {
+                const size_t parent = (index - 1ULL) / 2ULL;
+                if (!solver_entry_precedes(&entry, &open_list->entries[parent])) {
+                        break;
+                }
+
+                open_list->entries[index] = open_list->entries[parent];
+                index = parent;
+        }
+
+        open_list->entries[index] = entry;
+}
+
+static bool pop_solver_open_list(struct SolverOpenList *const open_list, struct SolverOpenEntry *const out_entry) {
+        if (open_list->count == 0ULL) {
+                return false;
+        }
+
+        *out_entry = open_list->entries[0];
+        const struct SolverOpenEntry last = open_list->entries[--open_list->count];
+
+        size_t index = 0ULL;
+        while (true) {
+                size_t child = index * 2ULL + 1ULL;
+                if (child >= open_list->count) {
+                        break;
+                }
+
+                if (child + 1ULL < open_list->count && solver_entry_precedes(&open_list->entries[child + 1ULL], &open_list->entries[child])) {
+                        ++child;
+                }
+
+                if (!solver_entry_precedes(&open_list->entries[child], &last)) {
+                        break;
+                }
+
+                open_list->entries[index] = open_list->entries[child];
+                index = child;
+        }
+
+        if (open_list->count > 0ULL) {
+                open_list->entries[index] = last;
+        }
+
+        return true;
+}
+
+static void push_solver_open(struct SolverWorker *const worker, const struct SolverOpenEntry entry) {
+        atomic_fetch_add_explicit(&worker->solver->pending_count, 1ULL, memory_order_relaxed);
+
+        lock_mutex(&worker->open_list.mutex);
+        push_solver_open_list(&worker->open_list, entry);
+        unlock_mutex(&worker->open_list.mutex);
+}
+
+// Takes the best entry of the worker's own open list, or steals up to half of the best entries of another worker
+static bool pop_solver_open(struct SolverWorker *const worker, struct SolverOpenEntry *const out_entry) {
+        lock_mutex(&worker->open_list.mutex);
+        const bool popped = pop_solver_open_list(&worker->open_list, out_entry);
+        unlock_mutex(&worker->open_list.mutex);
+
+        if (popped) {
+                return true;
+        }
+
+        struct Solver *const solver = worker->solver;
+        const size_t worker_index = (size_t)(worker - solver->workers);
+
+        for (size_t offset = 1ULL; offset < solver->worker_count; ++offset) {
+                struct SolverWorker *const victim = &solver->workers[(worker_index + offset) % solver->worker_count];
+
+                struct SolverOpenEntry stolen_entries[SOLVER_STEAL_LIMIT];
+                size_t stolen_count = 0ULL;
+
+                lock_mutex(&victim->open_list.mutex);
+                const size_t steal_count = MINIMUM_VALUE((victim->open_list.count + 1ULL) / 2ULL, SOLVER_STEAL_LIMIT);
+                while (stolen_count < steal_count && pop_solver_open_list(&victim->open_list, &stolen_entries[stolen_count])) {
+                        ++stolen_count;
+                }
+
+                unlock_mutex(&victim->open_list.mutex);
+
+                if (stolen_count == 0ULL) {
+                        continue;
+                }
+
+                lock_mutex(&worker->open_list.mutex);
+                for (size_t stolen_index = 1ULL; stolen_index < stolen_count; ++stolen_index) {
+                        push_solver_open_list(&worker->open_list, stolen_entries[stolen_index]);
+                }
+
+                unlock_mutex(&worker->open_list.mutex);
+
+                *out_entry = stolen_entries[0];
+                return true;
+        }
+
+        return false;
+}
+
+static struct SolverNode *allocate_solver_node(struct SolverWorker *const worker) {
+        if (worker->spare_node != NULL) {
+                struct SolverNode *const node = worker->spare_node;
+                worker->spare_node = NULL;
+                return node;
+        }
+
+        const struct Solver *const solver = worker->solver;
+        if (worker->chunk_count == 0ULL || worker->chunk_node_count == SOLVER_CHUNK_NODE_COUNT) {
+                if (worker->chunk_count == worker->chunk_capacity) {
+                        worker->chunk_capacity = MAXIMUM_VALUE(worker->chunk_capacity * 2ULL, 16ULL);
+                        worker->chunks = (uint8_t **)xrealloc(worker->chunks, worker->chunk_capacity * sizeof(uint8_t *));
+                }
+
+                worker->chunks[worker->chunk_count++] = (uint8_t *)xmalloc(SOLVER_CHUNK_NODE_COUNT * solver->node_stride);
+                worker->chunk_node_count = 0ULL;
+        }
+
+        return (struct SolverNode *)&worker->chunks[worker->chunk_count - 1ULL][worker->chunk_node_count++ * solver->node_stride];
+}
+
+// Gives back the node with the given tiles, adding it if no thread has seen it before. A node that was made but lost
+// the race for its slot is kept for the next time
+static struct SolverNode *find_solver_node(struct SolverWorker *const worker, const uint16_t *const tiles, bool *const out_added) {
+        struct Solver *const solver = worker->solver;
+        const uint16_t entity_count = solver->state->entity_count;
+        const uint64_t hash = hash_solver_tiles(tiles, entity_count);
+
+        size_t slot = hash & (solver->table_capacity - 1ULL);
+        while (true) {
+                struct SolverNode *node = atomic_load_explicit(&solver->table[slot], memory_order_acquire);
+
+                if (node == NULL) {
+                        struct SolverNode *const added_node = allocate_solver_node(worker);
+                        added_node->parent = NULL;
+                        added_node->hash = hash;
+                        atomic_flag_clear_explicit(&added_node->lock, memory_order_relaxed);
+                        added_node->cost = SOLVER_ESTIMATE_NONE;
+                        memcpy(added_node->tiles, tiles, entity_count * sizeof(uint16_t));
+
+                        if (atomic_compare_exchange_strong_explicit(&solver->table[slot], &node, added_node, memory_order_acq_rel, memory_order_acquire)) {
+                                if (atomic_fetch_add_explicit(&solver->node_count, 1ULL, memory_order_relaxed) + 1ULL >= solver->node_limit) {
+                                        atomic_store_explicit(&solver->stopped, true, memory_order_relaxed);
+                                }
+
+                                *out_added = true;
+                                return added_node;
+                        }
+
+                        worker->spare_node = added_node;
+                }
+
+                if (node->hash == hash && memcmp(node->tiles, tiles, entity_count * sizeof(uint16_t)) == 0) {
+                        *out_added = false;
+                        return node;
+                }
+
+                slot = (slot + 1ULL) & (solver->table_capacity - 1ULL);
+        }
+}
+
+// Points the node at the cheaper way to it, or returns false if it already had one at least as cheap
+static bool relax_solver_node(
+        struct SolverNode *const node,
+        struct SolverNode *const parent,
+        const uint32_t cost,
+        const uint16_t pusher_index,
+        const uint16_t push_tile_index,
+        const enum Orientation push_direction
+) {
+        lock_solver_node(node);
+
+        const bool relaxed = cost < node->cost;
+        if (relaxed) {
+                node->parent = parent;
+                node->cost = cost;
+                node->pusher_index = pusher_index;
+                node->push_tile_index = push_tile_index;
+                node->push_direction = (uint8_t)push_direction;
+        }
+
+        unlock_solver_node(node);
+        return relaxed;
+}
+
+static void record_solver_goal(struct Solver *const solver, struct SolverNode *const node, const uint32_t cost) {
+        lock_mutex(&solver->goal_mutex);
+
+        if (cost < atomic_load_explicit(&solver->best_cost, memory_order_relaxed)) {
+                solver->goal_node = node;
+                atomic_store_explicit(&solver->best_cost, cost, memory_order_relaxed);
+        }
+
+        unlock_mutex(&solver->goal_mutex);
+}
+
+// Finds every free tile the player can walk to, the walk queue ends up holding them in the order of their distance
+static size_t walk_solver_player(struct SolverWorker *const worker, const uint16_t player_index) {
+        const struct Solver *const solver = worker->solver;
+        const struct LevelState *const state = worker->state;
+        const struct EntityState *const player = &state->entities[player_index];
+        const uint16_t start_tile_index = (uint16_t)(player->row * state->columns + player->column);
+
+        for (uint16_t tile_index = 0; tile_index < state->tile_count; ++tile_index) {
+                worker->walk_distances[tile_index] = SOLVER_DISTANCE_NONE;
+        }
+
+        size_t queue_head = 0ULL;
+        size_t queue_tail = 0ULL;
+        worker->walk_distances[start_tile_index] = 0;
+        worker->walk_parents[start_tile_index] = SOLVER_DISTANCE_NONE;
+        worker->walk_queue[queue_tail++] = start_tile_index;
+
+        while (queue_head < queue_tail) {
+                const uint16_t tile_index = worker->walk_queue[queue_head++];
+                for (int direction = 0; direction < ORIENTATION_COUNT; ++direction) {
+                        const uint16_t neighbor_index = get_solver_neighbor(solver, tile_index, (enum Orientation)direction);
+                        if (neighbor_index == SOLVER_DISTANCE_NONE || worker->walk_distances[neighbor_index] != SOLVER_DISTANCE_NONE) {
+                                continue;
+                        }
+
+                        if (state->tiles[neighbor_index] == TILE_EMPTY || state->occupants[neighbor_index] != ENTITY_INDEX_NONE) {
+                                continue;
+                        }
+
+                        worker->walk_distances[neighbor_index] = (uint16_t)(worker->walk_distances[tile_index] + 1);
+                        worker->walk_parents[neighbor_index] = tile_index;
+                        worker->walk_queue[queue_tail++] = neighbor_index;
+                }
+        }
+
+        return queue_tail;
+}
+
+static void expand_solver_node(struct SolverWorker *const worker, struct SolverNode *const node, const uint32_t cost) {
+        struct Solver *const solver = worker->solver;
+        struct LevelState *const state = worker->state;
+
+        // Levels with fewer blocks than spots never get here, they are deadlocked from the start
+        fill_solver_costs(solver, node->tiles, worker->costs);
+        solve_assignment(&worker->assignment, worker->costs);
+
+        for (uint16_t player_index = 0; player_index < state->entity_count; ++player_index) {
+                if (solver->start_entities[player_index].type != ENTITY_PLAYER) {
+                        continue;
+                }
+
+                load_solver_node(worker, node, ENTITY_INDEX_NONE, 0, 0);
+                const size_t reached_count = walk_solver_player(worker, player_index);
+
+                for (size_t reached_index = 0ULL; reached_index < reached_count; ++reached_index) {
+                        const uint16_t tile_index = worker->walk_queue[reached_index];
+
+                        for (int direction = 0; direction < ORIENTATION_COUNT; ++direction) {
+                                // The tile the player walked away from is free by the time it pushes
+                                const uint16_t pushed_tile_index = get_solver_neighbor(solver, tile_index, (enum Orientation)direction);
+                                if (pushed_tile_index == SOLVER_DISTANCE_NONE || pushed_tile_index == node->tiles[player_index]) {
+                                        continue;
+                                }
+
+                                if (state->occupants[pushed_tile_index] == ENTITY_INDEX_NONE) {
+                                        continue;
+                                }
+
+                                load_solver_node(worker, node, player_index, tile_index, (enum Orientation)direction);
+
+                                size_t change_count;
+                                const enum InputResult result = apply_input(state, INPUT_FORWARD, worker->change_buffer, &change_count);
+                                if (result == INPUT_RESULT_PUSHED || result == INPUT_RESULT_WON) {
+                                        read_solver_tiles(state, worker->tiles);
+                                }
+
+                                load_solver_node(worker, node, ENTITY_INDEX_NONE, 0, 0);
+
+                                if ((result != INPUT_RESULT_PUSHED && result != INPUT_RESULT_WON) || is_solver_deadlocked(solver, worker->tiles)) {
+                                        continue;
+                                }
+
+                                const uint32_t next_cost = cost + worker->walk_distances[tile_index] + 1U;
+
+                                // The rest of the way from a cached state is known already, so it is a goal of its own
+                                const struct SolverCacheEntry *const cache_entry = solver->cache != NULL ? find_solver_cache_entry(solver->cache, worker->tiles) : NULL;
+                                if (cache_entry != NULL) {
+                                        const uint32_t goal_cost = next_cost + cache_entry->remaining_cost;
+                                        if (goal_cost >= atomic_load_explicit(&solver->best_cost, memory_order_relaxed)) {
+                                                continue;
+                                        }
+
+                                        bool added;
+                                        struct SolverNode *const cached_node = find_solver_node(worker, worker->tiles, &added);
+                                        if (added) {
+                                                ++worker->generated_node_count;
+                                        }
+
+                                        if (relax_solver_node(cached_node, node, next_cost, player_index, tile_index, (enum Orientation)direction)) {
+                                                record_solver_goal(solver, cached_node, goal_cost);
+                                        }
+
+                                        continue;
+                                }
+
+                                const uint32_t estimate = estimate_solver_successor_cost(worker, node, worker->tiles);
+                                if (estimate == SOLVER_ESTIMATE_NONE || next_cost + estimate >= atomic_load_explicit(&solver->best_cost, memory_order_relaxed)) {
+                                        continue;
+                                }
+
+                                bool added;
+                                struct SolverNode *const next_node = find_solver_node(worker, worker->tiles, &added);
+                                if (added) {
+                                        ++worker->generated_node_count;
+                                }
+
+                                if (!relax_solver_node(next_node, node, next_cost, player_index, tile_index, (enum Orientation)direction)) {
+                                        continue;
+                                }
+
+                                if (estimate == 0) {
+                                        record_solver_goal(solver, next_node, next_cost);
+                                        continue;
+                                }
+
+                                push_solver_open(worker, (struct SolverOpenEntry){next_cost + estimate, next_cost, next_node});
+                        }
+                }
+        }
+}
+
+static void run_solver_worker(void *const data) {
+        struct SolverWorker *const worker = (struct SolverWorker *)data;
+        struct Solver *const solver = worker->solver;
+
+        while (!is_solver_stopped(solver)) {
+                struct SolverOpenEntry entry;
+                if (!pop_solver_open(worker, &entry)) {
+                        // Other workers can still add entries as long as they are expanding
+                        if (atomic_load_explicit(&solver->pending_count, memory_order_acquire) == 0ULL) {
+                                break;
+                        }
+
+                        yield_thread();
+                        continue;
+                }
+
+                // An entry goes stale once a cheaper way to its node is found, and anything that can't beat the best
+                // goal so far is left alone. Expanding the rest is what eventually proves the best goal to be optimal
+                lock_solver_node(entry.node);
+                const uint32_t cost = entry.node->cost;
+                unlock_solver_node(entry.node);
+
+                if (entry.cost == cost && entry.estimate < atomic_load_explicit(&solver->best_cost, memory_order_relaxed)) {
+                        ++worker->expanded_node_count;
+                        expand_solver_node(worker, entry.node, cost);
+                }
+
+                atomic_fetch_sub_explicit(&solver->pending_count, 1ULL, memory_order_release);
+        }
+}
+
+// The solution is emitted input by input, and the states before every move are kept for the cache together with the
+// moves up to them and the push that comes next
+struct SolverEmission {
+        struct SolverSolution *solution;
+        size_t input_capacity;
+        struct SolverCacheEntry *records;
+        uint16_t *record_tiles;
+        size_t record_count;
+        size_t record_capacity;
+};
+
+static void emit_solver_input(struct SolverWorker *const worker, struct SolverEmission *const emission, const enum Input input) {
+        struct SolverSolution *const solution = emission->solution;
+        if (solution->input_count == emission->input_capacity) {
+                emission->input_capacity *= 2ULL;
+                solution->inputs = (enum Input *)xrealloc(solution->inputs, emission->input_capacity * sizeof(enum Input));
+        }
+
+        solution->inputs[solution->input_count++] = input;
+
+        if (input == INPUT_FORWARD || input == INPUT_BACKWARD) {
+                ++solution->move_count;
+        }
+
+        size_t change_count;
+        apply_input(worker->state, input, worker->change_buffer, &change_count);
+}
+
+// Steps the current player one tile in the given direction, walking backwards whenever that needs fewer turns
+static void emit_solver_step(struct SolverWorker *const worker, struct SolverEmission *const emission, const enum Orientation direction) {
+        const struct LevelState *const state = worker->state;
+        const enum Orientation orientation = (enum Orientation)state->entities[state->current_player_index].orientation;
+
+        const int forward_turns = ((int)direction - (int)orientation + ORIENTATION_COUNT) % ORIENTATION_COUNT;
+        const int backward_turns = (forward_turns + ORIENTATION_COUNT / 2) % ORIENTATION_COUNT;
+        const bool backwards = MINIMUM_VALUE(backward_turns, ORIENTATION_COUNT - backward_turns) < MINIMUM_VALUE(forward_turns, ORIENTATION_COUNT - forward_turns);
+        const enum Orientation facing = backwards ? orientation_reverse(direction) : direction;
+
+        while ((enum Orientation)state->entities[state->current_player_index].orientation != facing) {
+                emit_solver_input(worker, emission, get_turn_input((enum Orientation)state->entities[state->current_player_index].orientation, facing));
+        }
+
+        emit_solver_input(worker, emission, backwards ? INPUT_BACKWARD : INPUT_FORWARD);
+}
+
+static void record_solver_emission(struct Solver *const solver, struct SolverWorker *const worker, struct SolverEmission *const emission, const struct SolverCacheEntry *const push) {
+        if (solver->cache == NULL) {
+                return;
+        }
+
+        const size_t entity_count = MAXIMUM_VALUE((size_t)solver->state->entity_count, 1ULL);
+        if (emission->record_count == emission->record_capacity) {
+                emission->record_capacity = MAXIMUM_VALUE(emission->record_capacity * 2ULL, 64ULL);
+                emission->records = (struct SolverCacheEntry *)xrealloc(emission->records, emission->record_capacity * sizeof(struct SolverCacheEntry));
+                emission->record_tiles = (uint16_t *)xrealloc(emission->record_tiles, emission->record_capacity * entity_count * sizeof(uint16_t));
+        }
+
+        struct SolverCacheEntry *const record = &emission->records[emission->record_count];
+        *record = *push;
+        record->remaining_cost = (uint32_t)emission->solution->move_count;
+        read_solver_tiles(worker->state, &emission->record_tiles[emission->record_count * entity_count]);
+        ++emission->record_count;
+}
+
+// Switches to the pusher, walks it to the tile in front of what it pushes and pushes it
+static void emit_solver_push(struct Solver *const solver, struct SolverWorker *const worker, struct SolverEmission *const emission, const struct SolverCacheEntry *const push) {
+        struct LevelState *const state = worker->state;
+
+        while (state->current_player_index != push->pusher_index) {
+                emit_solver_input(worker, emission, INPUT_SWITCH);
+        }
+
+        walk_solver_player(worker, push->pusher_index);
+
+        // The walk parents lead from the push tile back to the player, so the path gets written back to front
+        const size_t path_length = (size_t)worker->walk_distances[push->push_tile_index];
+        size_t path_index = path_length;
+        for (uint16_t tile_index = push->push_tile_index; path_index > 0ULL; tile_index = worker->walk_parents[tile_index]) {
+                worker->walk_queue[--path_index] = tile_index;
+        }
+
+        for (path_index = 0ULL; path_index < path_length; ++path_index) {
+                record_solver_emission(solver, worker, emission, push);
+
+                const struct EntityState *const player = &state->entities[state->current_player_index];
+                const uint16_t player_tile_index = (uint16_t)(player->row * state->columns + player->column);
+
+                for (int direction = 0; direction < ORIENTATION_COUNT; ++direction) {
+                        if (get_solver_neighbor(solver, player_tile_index, (enum Orientation)direction) == worker->walk_queue[path_index]) {
+                                emit_solver_step(worker, emission, (enum Orientation)direction);
+                                break;
+                        }
+                }
+        }
+
+        record_solver_emission(solver, worker, emission, push);
+        emit_solver_step(worker, emission, (enum Orientation)push->push_direction);
+}
+
+// Plays the pushes from the start again to work out the inputs in between them. A search that ended on a cached
+// state goes on with the pushes in the cache, either way the last push has to win the level. Every state before a
+// move is exactly as far from winning as the rest of the solution, so they all go into the cache
+static bool emit_solver_solution(struct Solver *const solver, struct SolverSolution *const out_solution) {
+        struct SolverWorker *const worker = &solver->workers[0];
+        struct LevelState *const state = worker->state;
+        restore_level_state(state, solver->start_entities, solver->start_player_index);
+
+        size_t push_count = 0ULL;
+        for (const struct SolverNode *node = solver->goal_node; node->parent != NULL; node = node->parent) {
+                ++push_count;
+        }
+
+        const struct SolverNode **const pushes = (const struct SolverNode **)xmalloc(MAXIMUM_VALUE(push_count, 1ULL) * sizeof(struct SolverNode *));
+        size_t push_index = push_count;
+        for (const struct SolverNode *node = solver->goal_node; node->parent != NULL; node = node->parent) {
+                pushes[--push_index] = node;
+        }
+
+        *out_solution = (struct SolverSolution){0};
+        struct SolverEmission emission = {0};
+        emission.solution = out_solution;
+        emission.input_capacity = 64ULL;
+        out_solution->inputs = (enum Input *)xmalloc(emission.input_capacity * sizeof(enum Input));
+
+        for (push_index = 0ULL; push_index < push_count; ++push_index) {
+                const struct SolverNode *const node = pushes[push_index];
+
+                struct SolverCacheEntry push = {0};
+                push.pusher_index = node->pusher_index;
+                push.push_tile_index = node->push_tile_index;
+                push.push_direction = node->push_direction;
+                emit_solver_push(solver, worker, &emission, &push);
+        }
+
+        xfree(pushes);
+
+        // Every cached push leaves fewer moves to go, so this always ends
+        while (solver->cache != NULL && !is_level_state_won(state)) {
+                read_solver_tiles(state, worker->tiles);
+
+                const struct SolverCacheEntry *const cache_entry = find_solver_cache_entry(solver->cache, worker->tiles);
+                if (cache_entry == NULL || cache_entry->remaining_cost == 0) {
+                        break;
+                }
+
+                const struct SolverCacheEntry push = *cache_entry;
+                emit_solver_push(solver, worker, &emission, &push);
+        }
+
+        const bool won = is_level_state_won(state);
+
+        if (won) {
+                const size_t entity_count = MAXIMUM_VALUE((size_t)solver->state->entity_count, 1ULL);
+                for (size_t record_index = 0ULL; record_index < emission.record_count; ++record_index) {
+                        struct SolverCacheEntry *const record = &emission.records[record_index];
+                        record->remaining_cost = (uint32_t)out_solution->move_count - record->remaining_cost;
+                        add_solver_cache_entry(solver->cache, &emission.record_tiles[record_index * entity_count], record);
+                }
+        }
+
+        if (emission.records != NULL) {
+                xfree(emission.record_tiles);
+                xfree(emission.records);
+        }
+
+        return won;
+}
+
+bool solve_level_state(
+        struct LevelState *const state,
+        const size_t thread_count,
+        const size_t node_limit,
+        struct SolverCache *const cache,
+        const atomic_bool *const cancelled,
+        struct SolverSolution *const out_solution,
+        struct SolverStatistics *const out_statistics
+) {
+        *out_solution = (struct SolverSolution){0};
+        *out_statistics = (struct SolverStatistics){0};
+
+        const double start_seconds = get_solver_seconds();
+
+        struct Solver solver;
+        initialize_solver(&solver, state, thread_count == 0ULL ? get_processor_count() : thread_count, node_limit, cache, cancelled);
+
+        struct SolverWorker *const main_worker = &solver.workers[0];
+        read_solver_tiles(state, main_worker->tiles);
+
+        bool added;
+        struct SolverNode *const start_node = find_solver_node(main_worker, main_worker->tiles, &added);
+        relax_solver_node(start_node, NULL, 0, ENTITY_INDEX_NONE, 0, 0);
+        main_worker->generated_node_count = 1ULL;
+
+        const struct SolverCacheEntry *const start_cache_entry = cache != NULL ? find_solver_cache_entry(cache, main_worker->tiles) : NULL;
+
+        uint32_t start_estimate = SOLVER_ESTIMATE_NONE;
+        if (start_cache_entry != NULL) {
+                record_solver_goal(&solver, start_node, start_cache_entry->remaining_cost);
+        } else if (state->spot_count <= solver.block_count) {
+                fill_solver_costs(&solver, main_worker->tiles, main_worker->costs);
+                start_estimate = estimate_solver_cost(&solver, main_worker->costs, solve_assignment(&main_worker->assignment, main_worker->costs));
+        }
+
+        if (start_estimate == 0) {
+                record_solver_goal(&solver, start_node, 0);
+        } else if (start_estimate != SOLVER_ESTIMATE_NONE && !is_solver_deadlocked(&solver, main_worker->tiles)) {
+                push_solver_open(main_worker, (struct SolverOpenEntry){start_estimate, 0, start_node});
+        }
+
+        // The calling thread works as the first worker
+        size_t started_count = 1ULL;
+        while (started_count < solver.worker_count && start_thread(&solver.workers[started_count].thread, run_solver_worker, &solver.workers[started_count])) {
+                ++started_count;
+        }
+
+        run_solver_worker(main_worker);
+
+        for (size_t worker_index = 1ULL; worker_index < started_count; ++worker_index) {
+                join_thread(&solver.workers[worker_index].thread);
+        }
+
+        // Hitting the node limit means that a goal that was found isn't known to be the best one
+        bool solved = false;
+        if (solver.goal_node != NULL && !is_solver_stopped(&solver)) {
+                solved = emit_solver_solution(&solver, out_solution);
+                if (!solved) {
+                        send_message(MESSAGE_ERROR, "Failed to solve level state: The pushes that were found don't win the level");
+                        deinitialize_solver_solution(out_solution);
+                }
+        }
+
+        for (size_t worker_index = 0ULL; worker_index < solver.worker_count; ++worker_index) {
+                out_statistics->expanded_node_count += solver.workers[worker_index].expanded_node_count;
+                out_statistics->generated_node_count += solver.workers[worker_index].generated_node_count;
+        }
+
+        // Nothing is freed while searching, so the memory at the end is the peak
+        out_statistics->thread_count = started_count;
+        out_statistics->peak_memory_bytes = get_solver_memory(&solver);
+        out_statistics->seconds = get_solver_seconds() - start_seconds;
+
+        deinitialize_solver(&solver);
+        return solved;
+}
+
+void deinitialize_solver_solution(struct SolverSolution *const solution) {
+        if (solution->inputs != NULL) {
+                xfree(solution->inputs);
+        }
+
+        *solution = (struct SolverSolution){0};
+}
+
+void initialize_solver_cache(struct SolverCache *const cache, const struct LevelState *const state) {
+        cache->entity_count = state->entity_count;
+        cache->count = 0ULL;
+        cache->capacity = SOLVER_CACHE_INITIAL_CAPACITY;
+        cache->entries = (struct SolverCacheEntry *)xcalloc(cache->capacity, sizeof(struct SolverCacheEntry));
+        cache->tiles = (uint16_t *)xmalloc(cache->capacity * MAXIMUM_VALUE((size_t)cache->entity_count, 1ULL) * sizeof(uint16_t));
+}
+
+void deinitialize_solver_cache(struct SolverCache *const cache) {
+        xfree(cache->tiles);
+        xfree(cache->entries);
+        *cache = (struct SolverCache){0};
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "State.h"
+
+// The solver searches over the states in between pushes rather than over single inputs. From every state, each
+// player can walk to any tile it can reach and push whatever is in front of it, which is one edge that costs the
+// walked tiles plus the push. Turning and switching are free since they don't count as moves, so the orientations
+// don't matter and the search finds the fewest moves with A*. The heuristic is the cheapest assignment of blocks to
+// spots by their push distances, see 'estimate_solver_cost', and the dead tiles prune the states that can never be won.
+//
+// The search runs on several threads that share one transposition table. Each thread keeps its own open list and
+// steals the best entries of another thread's list when it runs dry. A node that is reached for less later on is
+// pushed again and expanded again, and the search only stops once nothing left can beat the best goal found.
+//
+// A player only walks right before it pushes, so a solution where a player has to step out of the way of another
+// player without pushing anything isn't found.
+
+struct SolverStatistics {
+        size_t thread_count;
+        size_t expanded_node_count;
+        size_t generated_node_count;
+        size_t peak_memory_bytes;
+        double seconds;
+};
+
+struct SolverCacheEntry {
+        uint64_t hash;
+        uint32_t remaining_cost;
+        uint16_t pusher_index;
+        uint16_t push_tile_index;
+        uint8_t push_direction;
+        bool used;
+};
+
+// The fewest moves left from the states along the solutions of earlier searches, keyed by the tiles of the entities
+// together with the next push from there. A search that reaches one of them knows the rest of the way right away, so
+// searching again from further along a solution that was found before is almost free
+struct SolverCache {
+        uint16_t entity_count;
+        size_t count;
+        size_t capacity;
+        struct SolverCacheEntry *entries;
+        uint16_t *tiles;
+};
+
+struct SolverSolution {
+        enum Input *inputs;
+        size_t input_count;
+        size_t move_count;
+};
+
+// The level state is used as scratch space while searching and is put back the way it was before returning. Returns
+// false if the level can't be won, the search ran out of nodes or it got cancelled, the statistics are filled in
+// either way. A thread count of zero uses one thread per processor. The cache and the cancellation flag are optional,
+// the cache gets the states along the solution added to it
+bool solve_level_state(
+        struct LevelState *const state,
+        const size_t thread_count,
+        const size_t node_limit,
+        struct SolverCache *const cache,
+        const atomic_bool *const cancelled,
+        struct SolverSolution *const out_solution,
+        struct SolverStatistics *const out_statistics
+);
+
+void deinitialize_solver_solution(struct SolverSolution *const solution);
+
+void initialize_solver_cache(struct SolverCache *const cache, const struct LevelState *const state);
+
+void deinitialize_solver_cache(struct SolverCache *const cache);
\ No newline at end of file
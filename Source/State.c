@@ -0,0 +1,757 @@
+#include "State.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cJSON.h"
+#include "Hexagons.h"
+#include "Memory.h"
+#include "Defines.h"
+#include "Debug.h"
+
+// The rules walk the entity table on every move, so an entity has to stay as small as the four bytes the rules need
+_Static_assert(sizeof(struct EntityState) == 4, "The entity state should stay four bytes");
+
+// Instead of a table of random keys, every key is derived from its (entity type, tile, orientation) triple with the
+// splitmix64 finalizer. That gives the same spread as a random table without having to fill or share one
+static inline uint64_t zobrist_key(const uint8_t entity_type, const uint16_t tile_index, const uint8_t orientation) {
+        uint64_t key = ((uint64_t)entity_type << 32 | (uint64_t)tile_index << 8 | (uint64_t)orientation) + 0x9E3779B97F4A7C15ULL;
+        key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+        return key ^ (key >> 31);
+}
+
+bool initialize_level_state(struct LevelState *const state, const char *const path, char **const out_title) {
+        *state = (struct LevelState){0};
+        state->current_player_index = ENTITY_INDEX_NONE;
+
+        char *const json_string = load_text_file(path);
+        if (!json_string) {
+                send_message(MESSAGE_ERROR, "Failed to initialize level state \"%s\": Failed to load level data file", path);
+                return false;
+        }
+
+        cJSON *const json = cJSON_Parse(json_string);
+        xfree(json_string);
+
+        if (!json) {
+                send_message(MESSAGE_ERROR, "Failed to initialize level state \"%s\": Failed to parse level data file: %s", path, cJSON_GetErrorPtr());
+                return false;
+        }
+
+        if (!parse_level_state(json, state, out_title)) {
+                send_message(MESSAGE_ERROR, "Failed to initialize level state \"%s\": Failed to parse level from level data file", path);
+                deinitialize_level_state(state);
+                cJSON_Delete(json);
+                return false;
+        }
+
+        cJSON_Delete(json);
+        return true;
+}
+
+void deinitialize_level_state(struct LevelState *const state) {
+        if (state == NULL) {
+                send_message(MESSAGE_WARNING, "Level state given to deinitialize is NULL");
+                return;
+        }
+
+        if (state->joints != NULL) {
+                xfree(state->joints);
+                state->joints = NULL;
+        }
+
+        if (state->group_indices != NULL) {
+                xfree(state->group_indices);
+                state->group_indices = NULL;
+        }
+
+        if (state->group_starts != NULL) {
+                xfree(state->group_starts);
+                state->group_starts = NULL;
+        }
+
+        if (state->group_members != NULL) {
+                xfree(state->group_members);
+                state->group_members = NULL;
+        }
+
+        if (state->entity_marks != NULL) {
+                xfree(state->entity_marks);
+                state->entity_marks = NULL;
+        }
+
+        if (state->occupants != NULL) {
+                xfree(state->occupants);
+                state->occupants = NULL;
+        }
+
+        if (state->entities != NULL) {
+                xfree(state->entities);
+                state->entities = NULL;
+        }
+
+        if (state->tiles != NULL) {
+                xfree(state->tiles);
+                state->tiles = NULL;
+        }
+}
+
+static inline uint16_t find_group_root(uint16_t *const parents, uint16_t entity_index) {
+        while (parents[entity_index] != entity_index) {
+                parents[entity_index] = parents[parents[entity_index]];
+                entity_index = parents[entity_index];
+        }
+
+        return entity_index;
+}
+
+// The joints are merged with union-find, then the members of every group are laid out next to each other
+static void create_level_state_groups(struct LevelState *const state) {
+        const uint16_t entity_count = state->entity_count;
+
+        uint16_t *const parents = (uint16_t *)xmalloc(MAXIMUM_VALUE((size_t)entity_count, 1ULL) * sizeof(uint16_t));
+        for (uint16_t entity_index = 0; entity_index < entity_count; ++entity_index) {
+                parents[entity_index] = entity_index;
+        }
+
+        for (uint16_t joint_index = 0; joint_index < state->joint_count; ++joint_index) {
+                const uint16_t root1 = find_group_root(parents, state->joints[joint_index].block1_index);
+                const uint16_t root2 = find_group_root(parents, state->joints[joint_index].block2_index);
+                if (root1 != root2) {
+                        parents[MAXIMUM_VALUE(root1, root2)] = MINIMUM_VALUE(root1, root2);
+                }
+        }
+
+        state->group_indices = (uint16_t *)xmalloc(MAXIMUM_VALUE((size_t)entity_count, 1ULL) * sizeof(uint16_t));
+        state->group_starts = (uint16_t *)xcalloc((size_t)entity_count + 1ULL, sizeof(uint16_t));
+        state->group_members = (uint16_t *)xmalloc(MAXIMUM_VALUE((size_t)entity_count, 1ULL) * sizeof(uint16_t));
+        state->entity_marks = (uint16_t *)xcalloc(MAXIMUM_VALUE((size_t)entity_count, 1ULL), sizeof(uint16_t));
+        state->entity_mark = 0;
+        state->group_count = 0;
+
+        // Roots always have the smallest index of their group, so they are seen before the rest of their members
+        for (uint16_t entity_index = 0; entity_index < entity_count; ++entity_index) {
+                const uint16_t root = find_group_root(parents, entity_index);
+                state->group_indices[entity_index] = GROUP_INDEX_NONE;
+
+                if (root == entity_index) {
+                        continue;
+                }
+
+                if (state->group_indices[root] == GROUP_INDEX_NONE) {
+                        state->group_indices[root] = state->group_count++;
+                }
+
+                state->group_indices[entity_index] = state->group_indices[root];
+        }
+
+        // Counting sort of the entities by their group
+        for (uint16_t entity_index = 0; entity_index < entity_count; ++entity_index) {
+                if (state->group_indices[entity_index] != GROUP_INDEX_NONE) {
+                        ++state->group_starts[state->group_indices[entity_index] + 1];
+                }
+        }
+
+        for (uint16_t group_index = 0; group_index < state->group_count; ++group_index) {
+                state->group_starts[group_index + 1] += state->group_starts[group_index];
+        }
+
+        uint16_t *const group_sizes = (uint16_t *)xcalloc(MAXIMUM_VALUE((size_t)state->group_count, 1ULL), sizeof(uint16_t));
+        for (uint16_t entity_index = 0; entity_index < entity_count; ++entity_index) {
+                const uint16_t group_index = state->group_indices[entity_index];
+                if (group_index != GROUP_INDEX_NONE) {
+                        state->group_members[state->group_starts[group_index] + group_sizes[group_index]++] = entity_index;
+                }
+        }
+
+        xfree(group_sizes);
+        xfree(parents);
+}
+
+bool parse_level_state(const cJSON *const json, struct LevelState *const state, char **const out_title) {
+        if (!cJSON_IsObject(json)) {
+                send_message(MESSAGE_ERROR, "Failed to parse level: JSON data is invalid");
+                return false;
+        }
+
+        const cJSON *const title_json    = cJSON_GetObjectItemCaseSensitive(json, "title");
+        const cJSON *const columns_json  = cJSON_GetObjectItemCaseSensitive(json, "columns");
+        const cJSON *const rows_json     = cJSON_GetObjectItemCaseSensitive(json, "rows");
+        const cJSON *const tiles_json    = cJSON_GetObjectItemCaseSensitive(json, "tiles");
+        const cJSON *const entities_json = cJSON_GetObjectItemCaseSensitive(json, "entities");
+        const cJSON *const joints_json   = cJSON_GetObjectItemCaseSensitive(json, "joints");
+        const cJSON *const par_json      = cJSON_GetObjectItemCaseSensitive(json, "par");
+
+        if (
+                !cJSON_IsString(title_json)   ||
+                !cJSON_IsNumber(columns_json) ||
+                !cJSON_IsNumber(rows_json)    ||
+                !cJSON_IsArray(tiles_json)    ||
+                !cJSON_IsArray(entities_json) ||
+                !cJSON_IsArray(joints_json)
+        ) {
+                send_message(MESSAGE_ERROR, "Failed to parse level: JSON data is invalid");
+                return false;
+        }
+
+        // The par is written by the solver at build time, levels without one just don't show it
+        if (par_json != NULL) {
+                const double par = cJSON_IsNumber(par_json) ? par_json->valuedouble : -1.0;
+                if (floor(par) != par || par < 0.0 || par > (double)UINT16_MAX) {
+                        send_message(MESSAGE_ERROR, "Failed to parse level: The par %lf is invalid, it should be an integer between 0 and %u", par, (unsigned int)UINT16_MAX);
+                        return false;
+                }
+
+                state->par_move_count = (uint16_t)par;
+        }
+
+        const double columns = columns_json->valuedouble;
+        if (floor(columns) != columns || columns <= 0.0 || columns > (double)LEVEL_DIMENSION_LIMIT) {
+                send_message(MESSAGE_ERROR, "Failed to parse level: The grid columns %lf is invalid, it should be an integer between 0 and %u", columns, LEVEL_DIMENSION_LIMIT);
+                return false;
+        }
+
+        const double rows = rows_json->valuedouble;
+        if (floor(rows) != rows || rows <= 0.0 || rows > (double)LEVEL_DIMENSION_LIMIT) {
+                send_message(MESSAGE_ERROR, "Failed to parse level: The grid rows %lf is invalid, it should be an integer between 0 and %u", rows, LEVEL_DIMENSION_LIMIT);
+                return false;
+        }
+
+        state->columns = (uint8_t)columns;
+        state->rows = (uint8_t)rows;
+
+        const size_t tile_count = (size_t)cJSON_GetArraySize(tiles_json);
+        state->tile_count = (uint16_t)((size_t)state->columns * (size_t)state->rows);
+        if (tile_count != state->tile_count) {
+                send_message(MESSAGE_ERROR, "Failed to parse level: The tile count of %zu does not match the expected tile count of %u (%u * %u)", tile_count, state->tile_count, state->columns, state->rows);
+                return false;
+        }
+
+        state->tiles = (enum TileType *)xmalloc(state->tile_count * sizeof(enum TileType));
+
+        size_t tile_index = 0ULL;
+        const cJSON *tile_json = NULL;
+        cJSON_ArrayForEach(tile_json, tiles_json) {
+                if (!cJSON_IsNumber(tile_json)) {
+                        send_message(MESSAGE_ERROR, "Failed to parse level: JSON data is invalid");
+                        return false;
+                }
+
+                const double tile = tile_json->valuedouble;
+                if (floor(tile) != tile || tile < 0.0 || (size_t)tile > (size_t)TILE_COUNT) {
+                        send_message(MESSAGE_ERROR, "Failed to parse level: The tile #%zu of %lf is invalid, it should be an integer between 0 and %d", tile_index, tile, (int)TILE_COUNT);
+                        return false;
+                }
+
+                state->tiles[tile_index] = (enum TileType)(uint8_t)tile;
+                if (state->tiles[tile_index] == TILE_SPOT) {
+                        ++state->spot_count;
+                }
+
+                ++tile_index;
+        }
+
+        const int entities_length = cJSON_GetArraySize(entities_json);
+        if (entities_length % LEVEL_DATA_ENTITY_STRIDE != 0) {
+                send_message(MESSAGE_ERROR, "Failed to parse level: Entities array length of %d is not a multiple of %d", entities_length, LEVEL_DATA_ENTITY_STRIDE);
+                return false;
+        }
+
+        state->entity_count = (uint16_t)(entities_length / LEVEL_DATA_ENTITY_STRIDE);
+        state->entities = (struct EntityState *)xcalloc(state->entity_count, sizeof(struct EntityState));
+
+        // Every tile remembers which entity stands on it so that tile queries don't have to scan the entities
+        state->occupants = (uint16_t *)xmalloc(state->tile_count * sizeof(uint16_t));
+        for (uint16_t tile_index = 0; tile_index < state->tile_count; ++tile_index) {
+                state->occupants[tile_index] = ENTITY_INDEX_NONE;
+        }
+
+        const cJSON *entity_part_json = entities_json->child;
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                const cJSON *const entity_type_json        = entity_part_json;
+                const cJSON *const entity_column_json      = entity_type_json->next;
+                const cJSON *const entity_row_json         = entity_column_json->next;
+                const cJSON *const entity_orientation_json = entity_row_json->next;
+                const cJSON *const entity_data_json        = entity_orientation_json->next;
+                entity_part_json                           = entity_data_json->next;
+
+                if (
+                        !cJSON_IsNumber(entity_type_json)        ||
+                        !cJSON_IsNumber(entity_column_json)      ||
+                        !cJSON_IsNumber(entity_row_json)         ||
+                        !cJSON_IsNumber(entity_orientation_json) ||
+                        !cJSON_IsNumber(entity_data_json)
+                ) {
+                        send_message(MESSAGE_ERROR, "Failed to parse level: Failed to parse entity %d: JSON data is invalid", (int)entity_index);
+                        return false;
+                }
+
+                struct EntityState *const entity = &state->entities[entity_index];
+                entity->type        = (uint8_t)entity_type_json->valuedouble;
+                entity->column      = (uint8_t)entity_column_json->valuedouble;
+                entity->row         = (uint8_t)entity_row_json->valuedouble;
+                entity->orientation = (uint8_t)entity_orientation_json->valuedouble;
+
+                const uint16_t entity_data = (uint16_t)entity_data_json->valuedouble;
+
+                if (entity->column >= state->columns || entity->row >= state->rows) {
+                        send_message(MESSAGE_ERROR, "Failed to parse level: Entity %d is outside of the grid at (%u, %u)", (int)entity_index, entity->column, entity->row);
+                        return false;
+                }
+
+                uint16_t *const occupant = &state->occupants[entity->row * state->columns + entity->column];
+                if (*occupant != ENTITY_INDEX_NONE) {
+                        send_message(MESSAGE_ERROR, "Failed to parse level: Entity %d overlaps entity %d at (%u, %u)", (int)entity_index, (int)*occupant, entity->column, entity->row);
+                        return false;
+                }
+
+                *occupant = entity_index;
+                state->entity_hash ^= zobrist_key(entity->type, (uint16_t)(entity->row * state->columns + entity->column), entity->orientation);
+
+                if (entity->type == ENTITY_BLOCK && state->tiles[entity->row * state->columns + entity->column] == TILE_SPOT) {
+                        ++state->covered_spot_count;
+                }
+
+                if (entity->type == ENTITY_PLAYER) {
+                        ++state->player_count;
+
+                        if (entity_data == 1) {
+#ifndef NDEBUG
+                                if (state->current_player_index != ENTITY_INDEX_NONE) {
+                                        send_message(MESSAGE_WARNING, "Multiple intially selected players found while parsing level");
+                                }
+#endif
+
+                                state->current_player_index = entity_index;
+                        }
+                }
+        }
+
+        if (state->current_player_index == ENTITY_INDEX_NONE) {
+                send_message(MESSAGE_ERROR, "Failed to parse level: No initially selected player found");
+                return false;
+        }
+
+        const int joints_length = cJSON_GetArraySize(joints_json);
+        if (joints_length % LEVEL_DATA_JOINT_STRIDE != 0) {
+                send_message(MESSAGE_ERROR, "Failed to parse level: Joints array length of %d is not a multiple of %d", joints_length, LEVEL_DATA_JOINT_STRIDE);
+                return false;
+        }
+
+        state->joint_count = (uint16_t)(joints_length / LEVEL_DATA_JOINT_STRIDE);
+        state->joints = (struct Joint *)xmalloc(state->joint_count * sizeof(struct Joint));
+
+        const cJSON *joint_part_json = joints_json->child;
+        for (uint16_t joint_index = 0; joint_index < state->joint_count; ++joint_index) {
+                const cJSON *const joint_type_json    = joint_part_json;
+                const cJSON *const joint_block1_index = joint_type_json->next;
+                const cJSON *const joint_block2_index = joint_block1_index->next;
+                joint_part_json                       = joint_block2_index->next;
+
+                if (
+                        !cJSON_IsNumber(joint_type_json)    ||
+                        !cJSON_IsNumber(joint_block1_index) ||
+                        !cJSON_IsNumber(joint_block2_index)
+                ) {
+                        send_message(MESSAGE_ERROR, "Failed to parse level: Failed to parse joint %d: JSON data is invalid", (int)joint_index);
+                        return false;
+                }
+
+                struct Joint *const joint = &state->joints[joint_index];
+                joint->type = (enum JointType)(int)joint_type_json->valuedouble;
+                joint->block1_index = (uint16_t)joint_block1_index->valuedouble;
+                joint->block2_index = (uint16_t)joint_block2_index->valuedouble;
+
+                if (
+                        joint->block1_index >= state->entity_count || state->entities[joint->block1_index].type != ENTITY_BLOCK ||
+                        joint->block2_index >= state->entity_count || state->entities[joint->block2_index].type != ENTITY_BLOCK ||
+                        joint->block1_index == joint->block2_index
+                ) {
+                        send_message(MESSAGE_ERROR, "Failed to parse level: Joint %d between entities %u and %u doesn't join two blocks", (int)joint_index, joint->block1_index, joint->block2_index);
+                        return false;
+                }
+        }
+
+        create_level_state_groups(state);
+
+        if (out_title != NULL) {
+                *out_title = xstrdup(title_json->valuestring);
+        }
+
+        return true;
+}
+
+void save_level_state(const struct LevelState *const state, struct EntityState *const out_entities, uint16_t *const out_current_player_index) {
+        memcpy(out_entities, state->entities, state->entity_count * sizeof(struct EntityState));
+        SAFE_ASSIGNMENT(out_current_player_index, state->current_player_index);
+}
+
+void restore_level_state(struct LevelState *const state, const struct EntityState *const entities, const uint16_t current_player_index) {
+        memcpy(state->entities, entities, state->entity_count * sizeof(struct EntityState));
+        state->current_player_index = current_player_index;
+
+        // Everything that 'apply_change' keeps up to date gets rebuilt from the restored entities
+        for (uint16_t tile_index = 0; tile_index < state->tile_count; ++tile_index) {
+                state->occupants[tile_index] = ENTITY_INDEX_NONE;
+        }
+
+        state->covered_spot_count = 0;
+        state->entity_hash = 0;
+
+        for (uint16_t entity_index = 0; entity_index < state->entity_count; ++entity_index) {
+                const struct EntityState *const entity = &state->entities[entity_index];
+                const uint16_t tile_index = (uint16_t)(entity->row * state->columns + entity->column);
+
+                state->occupants[tile_index] = entity_index;
+                state->entity_hash ^= zobrist_key(entity->type, tile_index, entity->orientation);
+
+                if (entity->type == ENTITY_BLOCK && state->tiles[tile_index] == TILE_SPOT) {
+                        ++state->covered_spot_count;
+                }
+        }
+}
+
+static inline void *duplicate_memory(const void *const memory, const size_t size) {
+        void *const duplicated = xmalloc(MAXIMUM_VALUE(size, 1ULL));
+        memcpy(duplicated, memory, size);
+        return duplicated;
+}
+
+void copy_level_state(const struct LevelState *const state, struct LevelState *const out_copy) {
+        *out_copy = *state;
+
+        const size_t entity_count = MAXIMUM_VALUE((size_t)state->entity_count, 1ULL);
+        out_copy->tiles = (enum TileType *)duplicate_memory(state->tiles, state->tile_count * sizeof(enum TileType));
+        out_copy->entities = (struct EntityState *)duplicate_memory(state->entities, state->entity_count * sizeof(struct EntityState));
+        out_copy->occupants = (uint16_t *)duplicate_memory(state->occupants, state->tile_count * sizeof(uint16_t));
+        out_copy->joints = (struct Joint *)duplicate_memory(state->joints, state->joint_count * sizeof(struct Joint));
+        out_copy->group_indices = (uint16_t *)duplicate_memory(state->group_indices, entity_count * sizeof(uint16_t));
+        out_copy->group_starts = (uint16_t *)duplicate_memory(state->group_starts, (entity_count + 1ULL) * sizeof(uint16_t));
+        out_copy->group_members = (uint16_t *)duplicate_memory(state->group_members, entity_count * sizeof(uint16_t));
+        out_copy->entity_marks = (uint16_t *)duplicate_memory(state->entity_marks, entity_count * sizeof(uint16_t));
+}
+
+size_t get_level_state_change_limit(const struct LevelState *const state) {
+        // A push chain can move every entity at most once and a switch always emits two changes
+        return MAXIMUM_VALUE((size_t)state->entity_count, 2ULL);
+}
+
+bool query_level_state_tile(
+        const struct LevelState *const state,
+        const uint8_t column,
+        const uint8_t row,
+        enum TileType *const out_tile_type,
+        uint16_t *const out_entity_index
+) {
+        if (column >= state->columns || row >= state->rows) {
+                return false;
+        }
+
+        const uint16_t tile_index = (uint16_t)(row * state->columns + column);
+        SAFE_ASSIGNMENT(out_tile_type, state->tiles[tile_index]);
+        SAFE_ASSIGNMENT(out_entity_index, state->occupants[tile_index]);
+
+        return true;
+}
+
+bool is_level_state_won(const struct LevelState *const state) {
+        return state->covered_spot_count == state->spot_count;
+}
+
+uint64_t hash_level_state(const struct LevelState *const state) {
+        // The current player is mixed in here rather than in 'apply_change' so that switching and moving the
+        // current player don't need any extra bookkeeping, 'ENTITY_COUNT' is used as the type of the selection key
+        const struct EntityState *const current_player = &state->entities[state->current_player_index];
+        return state->entity_hash ^ zobrist_key(ENTITY_COUNT, (uint16_t)(current_player->row * state->columns + current_player->column), 0);
+}
+
+static inline void block_changes(struct Change *const changes, const size_t change_count, const enum Orientation direction) {
+        // The entity that initiated the move recoils while the rest of the chain only shakes
+        for (size_t index = 0ULL; index < change_count; ++index) {
+                changes[index].type = index == 0ULL ? CHANGE_BLOCKED : CHANGE_INVALID;
+                changes[index].face.direction = direction;
+        }
+}
+
+// Adds the entity to the entities that have to move, together with every block it is joined to
+static inline void add_moving_entity(
+        struct LevelState *const state,
+        const uint16_t entity_index,
+        const enum Input input,
+        struct Change *const out_changes,
+        size_t *const change_count
+) {
+        const uint16_t group_index = state->group_indices[entity_index];
+        const uint16_t member_start = group_index == GROUP_INDEX_NONE ? 0 : state->group_starts[group_index];
+        const uint16_t member_end = group_index == GROUP_INDEX_NONE ? 1 : state->group_starts[group_index + 1];
+
+        for (uint16_t member = member_start; member < member_end; ++member) {
+                const uint16_t member_index = group_index == GROUP_INDEX_NONE ? entity_index : state->group_members[member];
+                if (state->entity_marks[member_index] == state->entity_mark) {
+                        continue;
+                }
+
+                state->entity_marks[member_index] = state->entity_mark;
+
+                const struct EntityState *const entity = &state->entities[member_index];
+                struct Change *const change = &out_changes[(*change_count)++];
+                change->input = input;
+                change->type = *change_count == 1ULL ? CHANGE_PUSH : CHANGE_PUSHED;
+                change->entity_index = member_index;
+                change->move.last_column = entity->column;
+                change->move.last_row = entity->row;
+        }
+}
+
+static enum InputResult apply_move(struct LevelState *const state, const enum Input input, struct Change *const out_changes, size_t *const out_change_count) {
+        const struct EntityState *const current_player = &state->entities[state->current_player_index];
+
+        enum Orientation direction = (enum Orientation)current_player->orientation;
+        if (input == INPUT_BACKWARD) {
+                direction = orientation_reverse(direction);
+        }
+
+        // A fresh mark tells apart the entities of this move from the ones of earlier moves without clearing them all
+        if (++state->entity_mark == 0) {
+                memset(state->entity_marks, 0, state->entity_count * sizeof(uint16_t));
+                state->entity_mark = 1;
+        }
+
+        // The changes double as the work list: every entity in it checks the tile in front of it and adds whatever
+        // stands there, so every tile in front of the moving entities is only looked at once
+        size_t change_count = 0ULL;
+        add_moving_entity(state, state->current_player_index, input, out_changes, &change_count);
+
+        for (size_t change_index = 0ULL; change_index < change_count; ++change_index) {
+                struct Change *const change = &out_changes[change_index];
+
+                size_t advanced_column, advanced_row;
+                if (!orientation_advance(direction, (size_t)change->move.last_column, (size_t)change->move.last_row, state->columns, state->rows, &advanced_column, &advanced_row)) {
+                        *out_change_count = change_count;
+                        block_changes(out_changes, change_count, direction);
+                        return INPUT_RESULT_BLOCKED;
+                }
+
+                change->move.next_column = (uint8_t)advanced_column;
+                change->move.next_row = (uint8_t)advanced_row;
+
+                // Advancing already kept the tile inside the grid, a tile that can't be queried counts as empty anyway
+                enum TileType tile_type = TILE_EMPTY;
+                uint16_t next_entity_index = ENTITY_INDEX_NONE;
+                if (!query_level_state_tile(state, change->move.next_column, change->move.next_row, &tile_type, &next_entity_index) || tile_type == TILE_EMPTY) {
+                        *out_change_count = change_count;
+                        block_changes(out_changes, change_count, direction);
+                        return INPUT_RESULT_HIT;
+                }
+
+                // Players can walk on slab tiles but blocks can't get pushed onto them
+                if (tile_type == TILE_SLAB && state->entities[change->entity_index].type == ENTITY_BLOCK) {
+                        *out_change_count = change_count;
+                        block_changes(out_changes, change_count, direction);
+                        return INPUT_RESULT_HIT;
+                }
+
+                if (next_entity_index != ENTITY_INDEX_NONE) {
+                        add_moving_entity(state, next_entity_index, input, out_changes, &change_count);
+                }
+        }
+
+        *out_change_count = change_count;
+
+        if (change_count == 1ULL) {
+                // This means that the next tile is valid but nothing will be pushed
+                out_changes[0].type = CHANGE_WALK;
+                apply_change(state, &out_changes[0]);
+                return INPUT_RESULT_WALKED;
+        }
+
+        // 'apply_change' only vacates tiles that weren't taken over already, so the order doesn't matter here
+        for (size_t index = 0ULL; index < change_count; ++index) {
+                apply_change(state, &out_changes[index]);
+        }
+
+        return is_level_state_won(state) ? INPUT_RESULT_WON : INPUT_RESULT_PUSHED;
+}
+
+static enum InputResult apply_turn(struct LevelState *const state, const enum Input input, struct Change *const out_changes, size_t *const out_change_count) {
+        const enum Orientation orientation = (enum Orientation)state->entities[state->current_player_index].orientation;
+        return apply_rotation(
+                state,
+                input == INPUT_RIGHT ? orientation_turn_right(orientation) : orientation_turn_left(orientation),
+                out_changes,
+                out_change_count
+        );
+}
+
+enum InputResult apply_input(struct LevelState *const state, const enum Input input, struct Change *const out_changes, size_t *const out_change_count) {
+        *out_change_count = 0ULL;
+
+        switch (input) {
+                case INPUT_FORWARD: case INPUT_BACKWARD: {
+                        return apply_move(state, input, out_changes, out_change_count);
+                }
+
+                case INPUT_LEFT: case INPUT_RIGHT: {
+                        return apply_turn(state, input, out_changes, out_change_count);
+                }
+
+                case INPUT_SWITCH: {
+                        // Cycle through entities to find the next player to switch to
+                        for (uint16_t index = 1; index < state->entity_count; ++index) {
+                                const uint16_t entity_index = (state->current_player_index + index) % state->entity_count;
+                                if (state->entities[entity_index].type == ENTITY_PLAYER) {
+                                        return apply_switch(state, entity_index, out_changes, out_change_count);
+                                }
+                        }
+
+                        return INPUT_RESULT_NONE;
+                }
+
+                // Undoing and redoing are handled by whoever keeps the history of the applied changes
+                default: {
+                        return INPUT_RESULT_NONE;
+                }
+        }
+}
+
+enum Input get_turn_input(const enum Orientation last_orientation, const enum Orientation next_orientation) {
+        // Turning left counts the orientations up, half a turn around goes left as well
+        const int turns = ((int)next_orientation - (int)last_orientation + ORIENTATION_COUNT) % ORIENTATION_COUNT;
+        return turns <= ORIENTATION_COUNT / 2 ? INPUT_LEFT : INPUT_RIGHT;
+}
+
+enum InputResult apply_rotation(struct LevelState *const state, const enum Orientation orientation, struct Change *const out_changes, size_t *const out_change_count) {
+        *out_change_count = 0ULL;
+
+        const enum Orientation current_orientation = (enum Orientation)state->entities[state->current_player_index].orientation;
+        if (orientation == current_orientation) {
+                return INPUT_RESULT_NONE;
+        }
+
+        struct Change *const change = &out_changes[0];
+        change->input = get_turn_input(current_orientation, orientation);
+        change->type = CHANGE_TURN;
+        change->entity_index = state->current_player_index;
+        change->turn.last_orientation = current_orientation;
+        change->turn.next_orientation = orientation;
+
+        apply_change(state, change);
+
+        *out_change_count = 1ULL;
+        return INPUT_RESULT_TURNED;
+}
+
+enum InputResult apply_switch(struct LevelState *const state, const uint16_t player_index, struct Change *const out_changes, size_t *const out_change_count) {
+        *out_change_count = 0ULL;
+
+        if (player_index >= state->entity_count || player_index == state->current_player_index || state->entities[player_index].type != ENTITY_PLAYER) {
+                return INPUT_RESULT_NONE;
+        }
+
+        struct Change *const current_player_change = &out_changes[0];
+        current_player_change->input = INPUT_SWITCH;
+        current_player_change->type = CHANGE_TOGGLE;
+        current_player_change->entity_index = state->current_player_index;
+        current_player_change->toggle.focused = false;
+
+        struct Change *const next_player_change = &out_changes[1];
+        next_player_change->input = INPUT_SWITCH;
+        next_player_change->type = CHANGE_TOGGLE;
+        next_player_change->entity_index = player_index;
+        next_player_change->toggle.focused = true;
+
+        apply_change(state, next_player_change);
+
+        *out_change_count = 2ULL;
+        return INPUT_RESULT_SWITCHED;
+}
+
+void apply_change(struct LevelState *const state, const struct Change *const change) {
+        struct EntityState *const entity = &state->entities[change->entity_index];
+
+        switch (change->type) {
+                case CHANGE_WALK: case CHANGE_PUSH: case CHANGE_PUSHED: {
+                        // The last tile is only vacated if no other entity of the same step has already moved onto it,
+                        // which keeps the occupants correct no matter in which order the changes of a step get applied
+                        uint16_t *const last_occupant = &state->occupants[change->move.last_row * state->columns + change->move.last_column];
+                        if (*last_occupant == change->entity_index) {
+                                *last_occupant = ENTITY_INDEX_NONE;
+                        }
+
+                        state->occupants[change->move.next_row * state->columns + change->move.next_column] = change->entity_index;
+
+                        // Only blocks count towards covering the spots, the counter is kept up to date instead of rescanning the tiles
+                        if (entity->type == ENTITY_BLOCK) {
+                                if (state->tiles[change->move.last_row * state->columns + change->move.last_column] == TILE_SPOT) {
+                                        --state->covered_spot_count;
+                                }
+
+                                if (state->tiles[change->move.next_row * state->columns + change->move.next_column] == TILE_SPOT) {
+                                        ++state->covered_spot_count;
+                                }
+                        }
+
+                        state->entity_hash ^= zobrist_key(entity->type, (uint16_t)(change->move.last_row * state->columns + change->move.last_column), entity->orientation);
+                        state->entity_hash ^= zobrist_key(entity->type, (uint16_t)(change->move.next_row * state->columns + change->move.next_column), entity->orientation);
+
+                        entity->column = change->move.next_column;
+                        entity->row = change->move.next_row;
+                        break;
+                }
+
+                case CHANGE_TURN: {
+                        const uint16_t tile_index = (uint16_t)(entity->row * state->columns + entity->column);
+                        state->entity_hash ^= zobrist_key(entity->type, tile_index, (uint8_t)change->turn.last_orientation);
+                        state->entity_hash ^= zobrist_key(entity->type, tile_index, (uint8_t)change->turn.next_orientation);
+
+                        entity->orientation = (uint8_t)change->turn.next_orientation;
+                        break;
+                }
+
+                case CHANGE_TOGGLE: {
+                        // Only the focused half of a switch carries the player that is switched to
+                        if (change->toggle.focused) {
+                                state->current_player_index = change->entity_index;
+                        }
+
+                        break;
+                }
+
+                case CHANGE_BLOCKED: case CHANGE_INVALID: {
+                        break;
+                }
+        }
+}
+
+void reverse_change(const struct Change *const change, struct Change *const out_reversed) {
+        *out_reversed = *change;
+
+        switch (change->type) {
+                case CHANGE_WALK: case CHANGE_PUSH: case CHANGE_PUSHED: {
+                        out_reversed->input = change->input == INPUT_FORWARD ? INPUT_BACKWARD : INPUT_FORWARD;
+
+                        SWAP_VALUES(uint8_t, out_reversed->move.last_column, out_reversed->move.next_column);
+                        SWAP_VALUES(uint8_t, out_reversed->move.last_row, out_reversed->move.next_row);
+                        break;
+                }
+
+                case CHANGE_TURN: {
+                        out_reversed->input = change->input == INPUT_LEFT ? INPUT_RIGHT : INPUT_LEFT;
+
+                        SWAP_VALUES(enum Orientation, out_reversed->turn.last_orientation, out_reversed->turn.next_orientation);
+                        break;
+                }
+
+                case CHANGE_TOGGLE: {
+                        out_reversed->toggle.focused = !change->toggle.focused;
+                        break;
+                }
+
+                case CHANGE_BLOCKED: case CHANGE_INVALID: {
+                        break;
+                }
+        }
+}
\ No newline at end of file
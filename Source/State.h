@@ -0,0 +1,174 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "Hexagons.h"
+
+// The level state holds the rules of a level without any SDL, audio or animation dependencies, the
+// 'Level' and 'Entity' layers only present the 'struct Change' records that it emits
+
+enum TileType {
+        TILE_EMPTY,
+        TILE_CELL,
+        TILE_SPOT,
+        TILE_SLAB,
+        TILE_COUNT
+};
+
+enum EntityType {
+        ENTITY_PLAYER = 0,
+        ENTITY_BLOCK,
+        ENTITY_COUNT
+};
+
+enum JointType {
+        JOINT_SOLID = 0,
+        JOINT_HONEY,
+        JOINT_COUNT
+};
+
+enum Input {
+        INPUT_FORWARD,
+        INPUT_BACKWARD,
+        INPUT_LEFT,
+        INPUT_RIGHT,
+        INPUT_SWITCH,
+        INPUT_UNDO,
+        INPUT_REDO,
+        INPUT_NONE
+};
+
+enum ChangeType {
+        CHANGE_WALK,
+        CHANGE_TURN,
+        CHANGE_PUSH,
+        CHANGE_PUSHED,
+        CHANGE_TOGGLE,
+        CHANGE_BLOCKED,
+        CHANGE_INVALID
+};
+
+struct Change {
+        enum Input input;
+        enum ChangeType type;
+        uint16_t entity_index;
+        union {
+                struct {
+                        uint8_t last_column, last_row;
+                        uint8_t next_column, next_row;
+                } move;
+                struct {
+                        enum Orientation last_orientation;
+                        enum Orientation next_orientation;
+                } turn;
+                struct {
+                        enum Orientation direction;
+                } face;
+                struct {
+                        bool focused;
+                } toggle;
+        };
+};
+
+enum InputResult {
+        INPUT_RESULT_NONE,
+        INPUT_RESULT_WALKED,
+        INPUT_RESULT_PUSHED,
+        INPUT_RESULT_TURNED,
+        INPUT_RESULT_SWITCHED,
+        INPUT_RESULT_BLOCKED,
+        INPUT_RESULT_HIT,
+        INPUT_RESULT_WON
+};
+
+struct EntityState {
+        uint8_t type;
+        uint8_t column;
+        uint8_t row;
+        uint8_t orientation;
+};
+
+struct Joint {
+        enum JointType type;
+        uint16_t block1_index;
+        uint16_t block2_index;
+};
+
+// Blocks that are joined together form a group that always moves as a whole. The groups are worked out once when the
+// level is parsed, 'group_indices' maps every entity to its group or 'GROUP_INDEX_NONE' and the members of group 'i'
+// are 'group_members[group_starts[i]]' up to 'group_members[group_starts[i + 1]]'. The entity marks are scratch space
+// for moves so that every entity is visited at most once per move
+struct LevelState {
+        uint8_t columns;
+        uint8_t rows;
+        uint16_t tile_count;
+        enum TileType *tiles;
+        uint16_t spot_count;
+        uint16_t covered_spot_count;
+        uint16_t entity_count;
+        uint16_t player_count;
+        uint16_t current_player_index;
+        struct EntityState *entities;
+        uint16_t *occupants;
+        uint64_t entity_hash;
+        uint16_t joint_count;
+        struct Joint *joints;
+        uint16_t group_count;
+        uint16_t *group_indices;
+        uint16_t *group_starts;
+        uint16_t *group_members;
+        uint16_t *entity_marks;
+        uint16_t entity_mark;
+        uint16_t par_move_count; // The fewest moves the level can be won in, zero if the level data has none
+};
+
+bool initialize_level_state(struct LevelState *const state, const char *const path, char **const out_title);
+
+void deinitialize_level_state(struct LevelState *const state);
+
+struct cJSON;
+bool parse_level_state(const struct cJSON *const json, struct LevelState *const state, char **const out_title);
+
+// Only the entities and the current player change while playing, so they are all that is needed to save and later
+// restore a level state. The buffer given to 'save_level_state' must be able to hold 'entity_count' entities
+void save_level_state(const struct LevelState *const state, struct EntityState *const out_entities, uint16_t *const out_current_player_index);
+
+void restore_level_state(struct LevelState *const state, const struct EntityState *const entities, const uint16_t current_player_index);
+
+// The copy owns all of its memory and has to be deinitialized on its own, which lets several threads work on the same
+// level at once
+void copy_level_state(const struct LevelState *const state, struct LevelState *const out_copy);
+
+// The buffer given to 'apply_input' must be able to hold at least this many changes
+size_t get_level_state_change_limit(const struct LevelState *const state);
+
+bool query_level_state_tile(
+        const struct LevelState *const state,
+        const uint8_t column,
+        const uint8_t row,
+        enum TileType *const out_tile_type,
+        uint16_t *const out_entity_index
+);
+
+bool is_level_state_won(const struct LevelState *const state);
+
+// Zobrist hash of every entity's type, tile and orientation together with the tile of the current player, it is kept
+// up to date by 'apply_change' so asking for it is constant time
+uint64_t hash_level_state(const struct LevelState *const state);
+
+enum InputResult apply_input(struct LevelState *const state, const enum Input input, struct Change *const out_changes, size_t *const out_change_count);
+
+// Turns the current player straight to the given orientation in a single change, which is how a whole run of turns
+// gets replayed once it was merged into one step
+enum InputResult apply_rotation(struct LevelState *const state, const enum Orientation orientation, struct Change *const out_changes, size_t *const out_change_count);
+
+// Which way a turn from one orientation to the other goes the shortest
+enum Input get_turn_input(const enum Orientation last_orientation, const enum Orientation next_orientation);
+
+enum InputResult apply_switch(struct LevelState *const state, const uint16_t player_index, struct Change *const out_changes, size_t *const out_change_count);
+
+void apply_change(struct LevelState *const state, const struct Change *const change);
+
+void reverse_change(const struct Change *const change, struct Change *const out_reversed);
\ No newline at end of file
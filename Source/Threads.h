@@ -0,0 +1,194 @@
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+// Just enough threading for the solver, the hints and the memory tracking they go through. SDL isn't used here so
+// that the headless tools can share the code with the game, and C11 threads aren't available everywhere
+
+#ifdef _WIN32
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+
+#else
+
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#endif
+
+struct Thread {
+        void (*function)(void *);
+        void *data;
+#ifdef _WIN32
+        HANDLE handle;
+#else
+        pthread_t handle;
+#endif
+};
+
+struct Mutex {
+#ifdef _WIN32
+        SRWLOCK lock;
+#else
+        pthread_mutex_t lock;
+#endif
+};
+
+struct Condition {
+#ifdef _WIN32
+        CONDITION_VARIABLE variable;
+#else
+        pthread_cond_t variable;
+#endif
+};
+
+// For mutexes with static storage, the others have to be initialized
+#ifdef _WIN32
+#define MUTEX_INITIALIZER {SRWLOCK_INIT}
+#else
+#define MUTEX_INITIALIZER {PTHREAD_MUTEX_INITIALIZER}
+#endif
+
+#ifdef _WIN32
+
+static inline DWORD WINAPI run_thread(LPVOID data) {
+        struct Thread *const thread = (struct Thread *)data;
+        thread->function(thread->data);
+        return 0;
+}
+
+#else
+
+static inline void *run_thread(void *data) {
+        struct Thread *const thread = (struct Thread *)data;
+        thread->function(thread->data);
+        return NULL;
+}
+
+#endif
+
+// The thread has to stay where it is until it is joined
+static inline bool start_thread(struct Thread *const thread, void (*const function)(void *), void *const data) {
+        thread->function = function;
+        thread->data = data;
+
+#ifdef _WIN32
+        thread->handle = CreateThread(NULL, 0, run_thread, thread, 0, NULL);
+        return thread->handle != NULL;
+#else
+        return pthread_create(&thread->handle, NULL, run_thread, thread) == 0;
+#endif
+}
+
+static inline void join_thread(struct Thread *const thread) {
+#ifdef _WIN32
+        WaitForSingleObject(thread->handle, INFINITE);
+        CloseHandle(thread->handle);
+#else
+        pthread_join(thread->handle, NULL);
+#endif
+}
+
+static inline void yield_thread(void) {
+#ifdef _WIN32
+        SwitchToThread();
+#else
+        sched_yield();
+#endif
+}
+
+static inline size_t get_processor_count(void) {
+#ifdef _WIN32
+        SYSTEM_INFO system_information;
+        GetSystemInfo(&system_information);
+        return system_information.dwNumberOfProcessors > 0 ? (size_t)system_information.dwNumberOfProcessors : 1ULL;
+#else
+        const long processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+        return processor_count > 0L ? (size_t)processor_count : 1ULL;
+#endif
+}
+
+static inline void initialize_mutex(struct Mutex *const mutex) {
+#ifdef _WIN32
+        InitializeSRWLock(&mutex->lock);
+#else
+        pthread_mutex_init(&mutex->lock, NULL);
+#endif
+}
+
+static inline void deinitialize_mutex(struct Mutex *const mutex) {
+#ifdef _WIN32
+        (void)mutex;
+#else
+        pthread_mutex_destroy(&mutex->lock);
+#endif
+}
+
+static inline void lock_mutex(struct Mutex *const mutex) {
+#ifdef _WIN32
+        AcquireSRWLockExclusive(&mutex->lock);
+#else
+        pthread_mutex_lock(&mutex->lock);
+#endif
+}
+
+static inline void unlock_mutex(struct Mutex *const mutex) {
+#ifdef _WIN32
+        ReleaseSRWLockExclusive(&mutex->lock);
+#else
+        pthread_mutex_unlock(&mutex->lock);
+#endif
+}
+
+// For the threads that can't wait, returns false right away if another thread holds the mutex
+static inline bool try_lock_mutex(struct Mutex *const mutex) {
+#ifdef _WIN32
+        return TryAcquireSRWLockExclusive(&mutex->lock) != 0;
+#else
+        return pthread_mutex_trylock(&mutex->lock) == 0;
+#endif
+}
+
+static inline void initialize_condition(struct Condition *const condition) {
+#ifdef _WIN32
+        InitializeConditionVariable(&condition->variable);
+#else
+        pthread_cond_init(&condition->variable, NULL);
+#endif
+}
+
+static inline void deinitialize_condition(struct Condition *const condition) {
+#ifdef _WIN32
+        (void)condition;
+#else
+        pthread_cond_destroy(&condition->variable);
+#endif
+}
+
+// The mutex has to be locked, it is unlocked while waiting and locked again before returning. Waking up doesn't mean
+// that whatever was waited for happened, so the caller checks again in a loop
+static inline void wait_condition(struct Condition *const condition, struct Mutex *const mutex) {
+#ifdef _WIN32
+        SleepConditionVariableSRW(&condition->variable, &mutex->lock, INFINITE, 0);
+#else
+        pthread_cond_wait(&condition->variable, &mutex->lock);
+#endif
+}
+
+static inline void signal_condition(struct Condition *const condition) {
+#ifdef _WIN32
+        WakeConditionVariable(&condition->variable);
+#else
+        pthread_cond_signal(&condition->variable);
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "Batch.h"
+#include "Debug.h"
+#include "Defines.h"
+#include "Memory.h"
+#include "State.h"
+#include "Tools.h"
+
+// Steps a batch of level instances in lockstep with random inputs, the way an agent tuning the levels would, and
+// reports how many environment steps go by every second together with how often the instances won or got stuck. The
+// levels are given as numbers or paths, without any the levels in 'Assets/Levels' are used until one is missing, and
+// every level gets the same number of instances in the one batch.
+//
+// '--instances' sets the instances of every level, '--steps' the steps the batch takes, '--depth' the maximum depth of
+// the step histories and '--seed' the seed of the inputs, the same seed always gives the same inputs
+
+#define BATCH_DEFAULT_INSTANCE_COUNT 256ULL
+
+#define BATCH_DEFAULT_STEP_COUNT 4096ULL
+
+// Agents rarely undo far, so the histories are kept short to keep every instance small
+#define BATCH_DEFAULT_MAXIMUM_DEPTH 64ULL
+
+#define BATCH_DEFAULT_SEED 0xBA7C4BA7C4BA7C4BULL
+
+// Moving forward comes up the most so that the random walks get around the level
+static const enum Input batch_inputs[] = {
+        INPUT_FORWARD, INPUT_FORWARD, INPUT_FORWARD, INPUT_FORWARD,
+        INPUT_BACKWARD, INPUT_BACKWARD,
+        INPUT_LEFT, INPUT_LEFT,
+        INPUT_RIGHT, INPUT_RIGHT,
+        INPUT_SWITCH,
+        INPUT_UNDO,
+        INPUT_REDO,
+        INPUT_NONE
+};
+
+#define BATCH_INPUT_COUNT (sizeof(batch_inputs) / sizeof(batch_inputs[0]))
+
+struct BatchLevel {
+        struct LevelState state;
+        char *title;
+};
+
+static bool load_batch_level(struct BatchLevel **const levels, size_t *const level_count, const char *const path) {
+        *levels = (struct BatchLevel *)xrealloc(*levels, (*level_count + 1ULL) * sizeof(struct BatchLevel));
+
+        struct BatchLevel *const level = &(*levels)[*level_count];
+        level->title = NULL;
+        if (!initialize_level_state(&level->state, path, &level->title)) {
+                fprintf(stderr, "%s: Failed to load level\n", path);
+                return false;
+        }
+
+        printf("%s \"%s\"\n", path, level->title);
+        ++*level_count;
+        return true;
+}
+
+int main(int argc, char *argv[]) {
+        size_t instance_count = BATCH_DEFAULT_INSTANCE_COUNT;
+        size_t step_count = BATCH_DEFAULT_STEP_COUNT;
+        size_t maximum_depth = BATCH_DEFAULT_MAXIMUM_DEPTH;
+        uint64_t seed = BATCH_DEFAULT_SEED;
+        struct BatchLevel *levels = NULL;
+        size_t level_count = 0ULL;
+        bool all_loaded = true;
+        bool given_levels = false;
+
+        for (int argument_index = 1; argument_index < argc; ++argument_index) {
+                const char *const argument = argv[argument_index];
+
+                if (strcmp(argument, "--instances") == 0 && argument_index + 1 < argc && is_number(argv[argument_index + 1])) {
+                        const size_t given_instance_count = (size_t)strtoull(argv[++argument_index], NULL, 10);
+                        instance_count = MAXIMUM_VALUE(given_instance_count, 1ULL);
+                        continue;
+                }
+
+                if (strcmp(argument, "--steps") == 0 && argument_index + 1 < argc && is_number(argv[argument_index + 1])) {
+                        step_count = (size_t)strtoull(argv[++argument_index], NULL, 10);
+                        continue;
+                }
+
+                if (strcmp(argument, "--depth") == 0 && argument_index + 1 < argc && is_number(argv[argument_index + 1])) {
+                        const size_t given_maximum_depth = (size_t)strtoull(argv[++argument_index], NULL, 10);
+                        maximum_depth = MAXIMUM_VALUE(given_maximum_depth, 1ULL);
+                        continue;
+                }
+
+                if (strcmp(argument, "--seed") == 0 && argument_index + 1 < argc && is_number(argv[argument_index + 1])) {
+                        seed = (uint64_t)strtoull(argv[++argument_index], NULL, 10);
+                        continue;
+                }
+
+                char level_path_buffer[TOOL_LEVEL_PATH_SIZE];
+                all_loaded &= load_batch_level(&levels, &level_count, get_level_argument_path(argument, level_path_buffer, sizeof(level_path_buffer)));
+                given_levels = true;
+        }
+
+        char level_path_buffer[TOOL_LEVEL_PATH_SIZE];
+        for (size_t number = 1ULL; !given_levels && query_default_level_path(number, level_path_buffer, sizeof(level_path_buffer)); ++number) {
+                all_loaded &= load_batch_level(&levels, &level_count, level_path_buffer);
+        }
+
+        const size_t batch_size = instance_count * level_count;
+        const struct LevelState **const states = (const struct LevelState **)xmalloc(MAXIMUM_VALUE(batch_size, 1ULL) * sizeof(struct LevelState *));
+        for (size_t instance_index = 0ULL; instance_index < batch_size; ++instance_index) {
+                states[instance_index] = &levels[instance_index / instance_count].state;
+        }
+
+        const double setup_start_seconds = get_tool_seconds();
+        struct LevelBatch batch;
+        initialize_level_batch(&batch, states, batch_size, maximum_depth);
+        const double setup_seconds = get_tool_seconds() - setup_start_seconds;
+
+        // Every buffer is allocated once up front, like an agent would
+        enum Input *const inputs = (enum Input *)xmalloc(MAXIMUM_VALUE(batch_size, 1ULL) * sizeof(enum Input));
+        uint64_t *const observations = (uint64_t *)xmalloc(MAXIMUM_VALUE(batch_size, 1ULL) * LEVEL_BATCH_OBSERVATION_WORD_COUNT * sizeof(uint64_t));
+        uint8_t *const flags = (uint8_t *)xmalloc(MAXIMUM_VALUE(batch_size, 1ULL) * sizeof(uint8_t));
+
+        reset_level_batch(&batch, observations, flags);
+
+        uint64_t random_state = MAXIMUM_VALUE(seed, 1ULL);
+        size_t changed_count = 0ULL;
+        size_t won_count = 0ULL;
+        size_t deadlocked_count = 0ULL;
+        double stepping_seconds = 0.0;
+        size_t stepping_allocation_count = 0ULL; // Only counted in debug builds, where the allocations are tracked
+
+        for (size_t step_index = 0ULL; step_index < step_count; ++step_index) {
+                for (size_t instance_index = 0ULL; instance_index < batch_size; ++instance_index) {
+                        inputs[instance_index] = batch_inputs[get_tool_random(&random_state) % BATCH_INPUT_COUNT];
+                }
+
+                const size_t start_allocation_count = get_memory_allocation_count();
+                const double start_seconds = get_tool_seconds();
+                step_level_batch(&batch, inputs, observations, flags);
+                stepping_seconds += get_tool_seconds() - start_seconds;
+                stepping_allocation_count += get_memory_allocation_count() - start_allocation_count;
+
+                for (size_t instance_index = 0ULL; instance_index < batch_size; ++instance_index) {
+                        changed_count += (flags[instance_index] & LEVEL_BATCH_FLAG_CHANGED) != 0;
+                        won_count += (flags[instance_index] & LEVEL_BATCH_FLAG_WON) != 0;
+                        deadlocked_count += (flags[instance_index] & LEVEL_BATCH_FLAG_DEADLOCKED) != 0;
+                }
+        }
+
+        const size_t environment_step_count = batch_size * step_count;
+        printf(
+                "%zu instances of %zu levels, %.3lf seconds to set up, %zu steps of %zu bytes of observations, %zu environment steps, %zu changed the level, %zu wins, %zu deadlocks, %.3lf seconds, %.0lf environment steps per second\n",
+                batch_size,
+                level_count,
+                setup_seconds,
+                step_count,
+                batch_size * LEVEL_BATCH_OBSERVATION_WORD_COUNT * sizeof(uint64_t),
+                environment_step_count,
+                changed_count,
+                won_count,
+                deadlocked_count,
+                stepping_seconds,
+                stepping_seconds > 0.0 ? (double)environment_step_count / stepping_seconds : 0.0
+        );
+
+        // Stepping is meant to run for hours on end, so a batch that allocates at all is a bug
+        if (stepping_allocation_count > 0ULL) {
+                fprintf(stderr, "Stepping the batch allocated %zu times\n", stepping_allocation_count);
+        }
+
+        xfree(flags);
+        xfree(observations);
+        xfree(inputs);
+        deinitialize_level_batch(&batch);
+        xfree(states);
+
+        for (size_t level_index = 0ULL; level_index < level_count; ++level_index) {
+                deinitialize_level_state(&levels[level_index].state);
+                xfree(levels[level_index].title);
+        }
+
+        if (levels != NULL) {
+                xfree(levels);
+        }
+
+        flush_memory_leaks();
+        return all_loaded && stepping_allocation_count == 0ULL ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "Debug.h"
+#include "Defines.h"
+#include "History.h"
+#include "Memory.h"
+#include "Replay.h"
+#include "State.h"
+#include "Tools.h"
+
+// Verifies replays without any SDL by playing them back on the levels in 'Assets/Levels'. The replays are given as
+// paths, without any they are read from the standard input one per line so that any number of them can be piped in.
+// Every replay that doesn't play back exactly like it was recorded is reported with the input it diverged at, and
+// with '--quiet' nothing else is printed besides the summary.
+//
+// With '--trail' the trail of the steps that every replay played back is written next to it with '.trail' appended,
+// which can be compared line by line against the trail the game dumps for the same session or against another build
+//
+// Every level is loaded once no matter how many replays are recorded on it
+
+struct ReplayLevel {
+        bool loaded;
+        bool missing;
+        struct ReplayVerifier verifier;
+};
+
+static struct ReplayLevel *levels = NULL;
+static size_t level_capacity = 0ULL;
+
+static const char input_names[] = {
+        [INPUT_FORWARD]       = 'F',
+        [INPUT_BACKWARD]      = 'B',
+        [INPUT_LEFT]          = 'L',
+        [INPUT_RIGHT]         = 'R',
+        [INPUT_SWITCH]        = 'S',
+        [INPUT_UNDO]          = 'U',
+        [INPUT_REDO]          = 'Y',
+        [INPUT_NONE]          = '?',
+        [REPLAY_CODE_RESTART] = 'X'
+};
+
+static struct ReplayVerifier *get_level_verifier(const uint16_t level_number) {
+        if (level_number >= level_capacity) {
+                const size_t next_capacity = MAXIMUM_VALUE((size_t)level_number + 1ULL, level_capacity * 2ULL);
+                levels = (struct ReplayLevel *)xrealloc(levels, next_capacity * sizeof(struct ReplayLevel));
+                memset(levels + level_capacity, 0, (next_capacity - level_capacity) * sizeof(struct ReplayLevel));
+                level_capacity = next_capacity;
+        }
+
+        struct ReplayLevel *const level = &levels[level_number];
+        if (!level->loaded && !level->missing) {
+                char level_path_buffer[TOOL_LEVEL_PATH_SIZE];
+                format_level_path((size_t)level_number, level_path_buffer, sizeof(level_path_buffer));
+
+                struct LevelState state;
+                char *title = NULL;
+                if (!initialize_level_state(&state, level_path_buffer, &title)) {
+                        fprintf(stderr, "%s: Failed to load level\n", level_path_buffer);
+                        level->missing = true;
+                        return NULL;
+                }
+
+                initialize_replay_verifier(&level->verifier, &state, STEP_HISTORY_MAXIMUM_DEPTH, false);
+                deinitialize_level_state(&state);
+                xfree(title);
+                level->loaded = true;
+        }
+
+        return level->loaded ? &level->verifier : NULL;
+}
+
+// Returns true if the replay plays back exactly like it was recorded, the replays that also won the level are counted
+static bool verify_replay_file(const char *const path, const bool quiet, const bool trailing, size_t *const won_count) {
+        struct Replay replay;
+        if (!read_replay(&replay, path)) {
+                printf("%s: Failed to read replay\n", path);
+                return false;
+        }
+
+        struct ReplayVerifier *const verifier = get_level_verifier(replay.level_number);
+        if (verifier == NULL) {
+                printf("%s: Level %u is missing\n", path, (unsigned int)replay.level_number);
+                deinitialize_replay(&replay);
+                return false;
+        }
+
+        struct ReplayVerification verification;
+        const bool verified = verify_replay(verifier, &replay, &verification);
+
+        switch (verification.divergence) {
+                case REPLAY_DIVERGENCE_NONE: {
+                        if (quiet) {
+                                break;
+                        }
+
+                        if (verification.won) {
+                                printf("%s: Level %u won in %zu moves at input %zu of %zu\n", path, (unsigned int)replay.level_number, verification.won_move_count, verification.won_input_index + 1, replay.code_count);
+                        } else {
+                                printf("%s: Level %u not won after %zu inputs\n", path, (unsigned int)replay.level_number, replay.code_count);
+                        }
+
+                        break;
+                }
+
+                case REPLAY_DIVERGENCE_LEVEL: {
+                        printf("%s: Recorded on another version of level %u\n", path, (unsigned int)replay.level_number);
+                        break;
+                }
+
+                case REPLAY_DIVERGENCE_INPUT: {
+                        printf(
+                                "%s: Diverged at input %zu of %zu, '%c' has no effect\n",
+                                path,
+                                verification.input_index + 1,
+                                replay.code_count,
+                                input_names[replay.codes[verification.input_index]]
+                        );
+                        break;
+                }
+
+                case REPLAY_DIVERGENCE_STATE: {
+                        printf(
+                                "%s: Diverged between inputs %zu and %zu of %zu, the state doesn't match the recording\n",
+                                path,
+                                verification.matched_input_count + 1,
+                                verification.input_index + 1,
+                                replay.code_count
+                        );
+                        break;
+                }
+        }
+
+        if (verified && verification.won) {
+                ++*won_count;
+        }
+
+        if (trailing && verification.divergence != REPLAY_DIVERGENCE_LEVEL) {
+                char trail_path_buffer[4096ULL + 8ULL];
+                snprintf(trail_path_buffer, sizeof(trail_path_buffer), "%s.trail", path);
+
+                FILE *const file = fopen(trail_path_buffer, "w");
+                if (file != NULL) {
+                        dump_step_history_trail(&verifier->step_history, file);
+                        fclose(file);
+                } else {
+                        fprintf(stderr, "%s: Failed to write the trail\n", trail_path_buffer);
+                }
+        }
+
+        deinitialize_replay(&replay);
+        return verified;
+}
+
+int main(int argc, char *argv[]) {
+        bool quiet = false;
+        bool trailing = false;
+        size_t replay_count = 0ULL;
+        size_t verified_count = 0ULL;
+        size_t won_count = 0ULL;
+        bool reading_input = true;
+
+        const double start_seconds = get_tool_seconds();
+
+        for (int argument_index = 1; argument_index < argc; ++argument_index) {
+                const char *const argument = argv[argument_index];
+
+                if (strcmp(argument, "--quiet") == 0) {
+                        quiet = true;
+                        continue;
+                }
+
+                if (strcmp(argument, "--trail") == 0) {
+                        trailing = true;
+                        continue;
+                }
+
+                verified_count += verify_replay_file(argument, quiet, trailing, &won_count) ? 1ULL : 0ULL;
+                ++replay_count;
+                reading_input = false;
+        }
+
+        char path_buffer[4096ULL];
+        while (reading_input && fgets(path_buffer, sizeof(path_buffer), stdin) != NULL) {
+                path_buffer[strcspn(path_buffer, "\r\n")] = '\0';
+                if (path_buffer[0] == '\0') {
+                        continue;
+                }
+
+                verified_count += verify_replay_file(path_buffer, quiet, trailing, &won_count) ? 1ULL : 0ULL;
+                ++replay_count;
+        }
+
+        const double seconds = get_tool_seconds() - start_seconds;
+        printf(
+                "%zu of %zu replays verified, %zu won, %.3lf seconds, %.0lf replays per second\n",
+                verified_count,
+                replay_count,
+                won_count,
+                seconds,
+                seconds > 0.0 ? (double)replay_count / seconds : 0.0
+        );
+
+        for (size_t level_number = 0ULL; level_number < level_capacity; ++level_number) {
+                if (levels[level_number].loaded) {
+                        deinitialize_replay_verifier(&levels[level_number].verifier);
+                }
+        }
+
+        if (levels != NULL) {
+                xfree(levels);
+        }
+
+        flush_memory_leaks();
+        return verified_count == replay_count ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
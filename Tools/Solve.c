@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "Debug.h"
+#include "Defines.h"
+#include "Memory.h"
+#include "Solver.h"
+#include "State.h"
+#include "Threads.h"
+#include "Tools.h"
+
+// Solves levels without any SDL so that every level can be checked for being solvable and for its fewest moves. The
+// levels are given as numbers or paths, without any the levels in 'Assets/Levels' are solved until one is missing.
+// With '--scaling' every level is solved again with twice the threads each time up to the processor count.
+//
+// Levels keep the fewest moves they can be won in as their par, which the game shows next to the move count. A par
+// that doesn't match the solution counts as a failure, '--write-par' writes the solved move count into the level
+// files instead
+
+// The transposition table is sized for the limit up front, so the limit decides the memory that is taken right away
+#define SOLVE_DEFAULT_NODE_LIMIT 4194304ULL
+
+static const char input_names[] = {
+        [INPUT_FORWARD]  = 'F',
+        [INPUT_BACKWARD] = 'B',
+        [INPUT_LEFT]     = 'L',
+        [INPUT_RIGHT]    = 'R',
+        [INPUT_SWITCH]   = 'S',
+        [INPUT_UNDO]     = 'U',
+        [INPUT_REDO]     = 'Y',
+        [INPUT_NONE]     = '?'
+};
+
+static void print_solver_statistics(const struct SolverStatistics *const statistics) {
+        printf(
+                "        %zu threads, %zu nodes expanded, %zu nodes generated, %.3lf seconds, %.0lf nodes per second, %.2lf MiB peak memory\n",
+                statistics->thread_count,
+                statistics->expanded_node_count,
+                statistics->generated_node_count,
+                statistics->seconds,
+                statistics->seconds > 0.0 ? (double)statistics->expanded_node_count / statistics->seconds : 0.0,
+                (double)statistics->peak_memory_bytes / (1024.0 * 1024.0)
+        );
+}
+
+// Solves the level with 1, 2, 4 and so on threads, the speedup is against the single threaded run
+static void measure_level_scaling(struct LevelState *const state, const size_t node_limit) {
+        const size_t processor_count = get_processor_count();
+
+        double single_seconds = 0.0;
+        size_t thread_count = 1ULL;
+        while (true) {
+                struct SolverSolution solution;
+                struct SolverStatistics statistics;
+                const bool solved = solve_level_state(state, thread_count, node_limit, NULL, NULL, &solution, &statistics);
+
+                if (thread_count == 1ULL) {
+                        single_seconds = statistics.seconds;
+                }
+
+                printf(
+                        "        %2zu threads: %s in %zu moves, %.3lf seconds, %.0lf nodes per second, %.2lfx speedup\n",
+                        thread_count,
+                        solved ? "Solved" : "Not solved",
+                        solution.move_count,
+                        statistics.seconds,
+                        statistics.seconds > 0.0 ? (double)statistics.expanded_node_count / statistics.seconds : 0.0,
+                        statistics.seconds > 0.0 ? single_seconds / statistics.seconds : 0.0
+                );
+
+                deinitialize_solver_solution(&solution);
+
+                // The processor count gets a run of its own when it isn't a power of two
+                if (thread_count >= processor_count) {
+                        break;
+                }
+
+                thread_count = MINIMUM_VALUE(thread_count * 2ULL, processor_count);
+        }
+}
+
+// Only the par gets touched so that the rest of the hand written level file stays the way it is. The par goes right
+// after the title if the level doesn't have one yet
+static bool write_level_par(const char *const path, const size_t par_move_count) {
+        char *const text = load_text_file(path);
+        if (text == NULL) {
+                return false;
+        }
+
+        const char *prefix_end;
+        const char *suffix_start;
+
+        char par_string[32ULL];
+        const char *const par_key = strstr(text, "\"par\"");
+        if (par_key != NULL) {
+                prefix_end = strchr(par_key, ':') + 1;
+                suffix_start = prefix_end + strspn(prefix_end, " \t");
+                suffix_start += strspn(suffix_start, "0123456789");
+                snprintf(par_string, sizeof(par_string), " %zu", par_move_count);
+        } else {
+                const char *const title_key = strstr(text, "\"title\"");
+                const char *const title_end = title_key != NULL ? strchr(title_key, '\n') : NULL;
+                if (title_end == NULL) {
+                        fprintf(stderr, "%s: Failed to find the title to put the par after\n", path);
+                        xfree(text);
+                        return false;
+                }
+
+                prefix_end = title_end + 1;
+                suffix_start = prefix_end;
+                snprintf(par_string, sizeof(par_string), "        \"par\": %zu,\n", par_move_count);
+        }
+
+        FILE *const file = fopen(path, "wb");
+        if (file == NULL) {
+                fprintf(stderr, "%s: Failed to write the par\n", path);
+                xfree(text);
+                return false;
+        }
+
+        fwrite(text, 1ULL, (size_t)(prefix_end - text), file);
+        fputs(par_string, file);
+        fputs(suffix_start, file);
+        fclose(file);
+
+        xfree(text);
+        return true;
+}
+
+static bool solve_level(const char *const path, const size_t thread_count, const size_t node_limit, const bool scaling, const bool writing_par) {
+        struct LevelState state;
+        char *title = NULL;
+        if (!initialize_level_state(&state, path, &title)) {
+                fprintf(stderr, "%s: Failed to load level\n", path);
+                return false;
+        }
+
+        struct SolverSolution solution;
+        struct SolverStatistics statistics;
+        bool solved = solve_level_state(&state, thread_count, node_limit, NULL, NULL, &solution, &statistics);
+
+        if (solved) {
+                printf("%s \"%s\": Solved in %zu moves (%zu inputs)\n        ", path, title, solution.move_count, solution.input_count);
+                for (size_t input_index = 0ULL; input_index < solution.input_count; ++input_index) {
+                        putchar(input_names[solution.inputs[input_index]]);
+                }
+
+                putchar('\n');
+
+                if (writing_par && state.par_move_count != solution.move_count) {
+                        if (write_level_par(path, solution.move_count)) {
+                                printf("        Par written as %zu moves\n", solution.move_count);
+                        }
+                } else if (state.par_move_count != solution.move_count) {
+                        printf("        Par of %u moves is out of date, it should be %zu moves\n", (unsigned int)state.par_move_count, solution.move_count);
+                        solved = false;
+                }
+        } else if (statistics.generated_node_count >= node_limit) {
+                printf("%s \"%s\": Gave up after %zu nodes\n", path, title, statistics.generated_node_count);
+        } else {
+                printf("%s \"%s\": Unsolvable\n", path, title);
+        }
+
+        print_solver_statistics(&statistics);
+        deinitialize_solver_solution(&solution);
+
+        if (scaling) {
+                measure_level_scaling(&state, node_limit);
+        }
+
+        deinitialize_level_state(&state);
+        xfree(title);
+        return solved;
+}
+
+int main(int argc, char *argv[]) {
+        size_t node_limit = SOLVE_DEFAULT_NODE_LIMIT;
+        size_t thread_count = 0ULL;
+        bool scaling = false;
+        bool writing_par = false;
+        size_t level_count = 0ULL;
+        bool all_solved = true;
+
+        for (int argument_index = 1; argument_index < argc; ++argument_index) {
+                const char *const argument = argv[argument_index];
+
+                if (strcmp(argument, "--limit") == 0 && argument_index + 1 < argc && is_number(argv[argument_index + 1])) {
+                        node_limit = (size_t)strtoull(argv[++argument_index], NULL, 10);
+                        continue;
+                }
+
+                if (strcmp(argument, "--threads") == 0 && argument_index + 1 < argc && is_number(argv[argument_index + 1])) {
+                        thread_count = (size_t)strtoull(argv[++argument_index], NULL, 10);
+                        continue;
+                }
+
+                if (strcmp(argument, "--scaling") == 0) {
+                        scaling = true;
+                        continue;
+                }
+
+                if (strcmp(argument, "--write-par") == 0) {
+                        writing_par = true;
+                        continue;
+                }
+
+                char level_path_buffer[TOOL_LEVEL_PATH_SIZE];
+                all_solved &= solve_level(get_level_argument_path(argument, level_path_buffer, sizeof(level_path_buffer)), thread_count, node_limit, scaling, writing_par);
+                ++level_count;
+        }
+
+        char level_path_buffer[TOOL_LEVEL_PATH_SIZE];
+        for (size_t number = 1ULL; level_count == 0ULL && query_default_level_path(number, level_path_buffer, sizeof(level_path_buffer)); ++number) {
+                all_solved &= solve_level(level_path_buffer, thread_count, node_limit, scaling, writing_par);
+        }
+
+        flush_memory_leaks();
+        return all_solved ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,337 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "Debug.h"
+#include "Defines.h"
+#include "History.h"
+#include "Memory.h"
+#include "Replay.h"
+#include "State.h"
+#include "Tools.h"
+
+// Drives random inputs through the rules of the levels without any SDL, with the same step rules as the game, and
+// checks the step history against snapshots of the level state along the way. Every undo has to bring back exactly
+// the state from before the step, together with its move count, current player, state hash and covered spots, and
+// every redo the state after it. The occupants, the hash and the covered spots, which the moves keep up to date as they
+// go, also have to match the ones rebuilt from the entities. Every level is stressed with a full and with a compact
+// step history. The levels are given as numbers or paths, without any the levels in 'Assets/Levels' are stressed until
+// one is missing.
+//
+// '--inputs' sets the inputs for every level and history, '--depth' the maximum depth of the step history and
+// '--seed' the seed of the inputs, the same seed always gives the same inputs
+
+#define STRESS_DEFAULT_INPUT_COUNT 1000000ULL
+
+// Much shallower than the game's history, so that the oldest steps get evicted all the time
+#define STRESS_DEFAULT_MAXIMUM_DEPTH 1024ULL
+
+#define STRESS_DEFAULT_SEED 0x5EED5EED5EED5EEDULL
+
+// Moving forward comes up the most so that the random walks get around the level instead of undoing it all the time
+static const enum Input stress_inputs[] = {
+        INPUT_FORWARD, INPUT_FORWARD, INPUT_FORWARD, INPUT_FORWARD, INPUT_FORWARD, INPUT_FORWARD,
+        INPUT_BACKWARD, INPUT_BACKWARD, INPUT_BACKWARD,
+        INPUT_LEFT, INPUT_LEFT, INPUT_LEFT,
+        INPUT_RIGHT, INPUT_RIGHT, INPUT_RIGHT,
+        INPUT_SWITCH, INPUT_SWITCH,
+        INPUT_UNDO, INPUT_UNDO, INPUT_UNDO, INPUT_UNDO,
+        INPUT_REDO, INPUT_REDO, INPUT_REDO
+};
+
+#define STRESS_INPUT_COUNT (sizeof(stress_inputs) / sizeof(stress_inputs[0]))
+
+// A snapshot of the level state after every kept step, the entities of snapshot 'i' are at 'i * entity_count'. The
+// rebuilt state gets the entities of the state being checked restored into it, which rebuilds everything that moves
+// and the step history keep up to date as they go
+struct StressSnapshots {
+        uint16_t entity_count;
+        size_t length;
+        struct EntityState *entities;
+        uint16_t *player_indices;
+        size_t *move_counts;
+        uint64_t *state_hashes;
+        uint16_t *covered_spot_counts;
+        struct LevelState rebuilt_state;
+};
+
+struct StressStatistics {
+        size_t input_count;
+        size_t move_count;
+        size_t undo_count;
+        size_t redo_count;
+        size_t evicted_step_count;
+        double seconds;
+        size_t peak_memory_bytes;
+};
+
+static void take_stress_snapshot(struct StressSnapshots *const snapshots, const struct ReplayVerifier *const verifier, const size_t step_index) {
+        save_level_state(&verifier->state, &snapshots->entities[step_index * snapshots->entity_count], &snapshots->player_indices[step_index]);
+        snapshots->move_counts[step_index] = verifier->step_history.move_count;
+        snapshots->state_hashes[step_index] = hash_level_state(&verifier->state);
+        snapshots->covered_spot_counts[step_index] = verifier->state.covered_spot_count;
+}
+
+// Gives back what doesn't match the snapshot or NULL if everything does
+static const char *compare_stress_snapshot(struct StressSnapshots *const snapshots, const struct ReplayVerifier *const verifier, const size_t step_index) {
+        if (memcmp(verifier->state.entities, &snapshots->entities[step_index * snapshots->entity_count], snapshots->entity_count * sizeof(struct EntityState)) != 0) {
+                return "entities";
+        }
+
+        if (verifier->state.current_player_index != snapshots->player_indices[step_index]) {
+                return "current player";
+        }
+
+        if (verifier->step_history.move_count != snapshots->move_counts[step_index]) {
+                return "move count";
+        }
+
+        if (hash_level_state(&verifier->state) != snapshots->state_hashes[step_index]) {
+                return "state hash";
+        }
+
+        if (verifier->state.covered_spot_count != snapshots->covered_spot_counts[step_index]) {
+                return "covered spot count";
+        }
+
+        struct LevelState *const rebuilt_state = &snapshots->rebuilt_state;
+        restore_level_state(rebuilt_state, verifier->state.entities, verifier->state.current_player_index);
+
+        if (memcmp(verifier->state.occupants, rebuilt_state->occupants, verifier->state.tile_count * sizeof(uint16_t)) != 0) {
+                return "occupants";
+        }
+
+        if (verifier->state.entity_hash != rebuilt_state->entity_hash || verifier->state.covered_spot_count != rebuilt_state->covered_spot_count) {
+                return "rebuilt state";
+        }
+
+        return NULL;
+}
+
+static bool stress_level_state(
+        const struct LevelState *const state,
+        const size_t input_count,
+        const size_t maximum_depth,
+        const bool compact,
+        const uint64_t seed,
+        struct StressStatistics *const out_statistics
+) {
+        *out_statistics = (struct StressStatistics){0};
+
+        struct ReplayVerifier verifier;
+        initialize_replay_verifier(&verifier, state, maximum_depth, compact);
+        struct StepHistory *const step_history = &verifier.step_history;
+
+        // Evicting only happens once the history is a keyframe interval past its depth, and a push comes right before it
+        const size_t snapshot_capacity = maximum_depth + HISTORY_KEYFRAME_INTERVAL + 1ULL;
+        struct StressSnapshots snapshots;
+        snapshots.entity_count = state->entity_count;
+        snapshots.length = 1ULL;
+        snapshots.entities = (struct EntityState *)xmalloc(MAXIMUM_VALUE(snapshot_capacity * state->entity_count, 1ULL) * sizeof(struct EntityState));
+        snapshots.player_indices = (uint16_t *)xmalloc(snapshot_capacity * sizeof(uint16_t));
+        snapshots.move_counts = (size_t *)xmalloc(snapshot_capacity * sizeof(size_t));
+        snapshots.state_hashes = (uint64_t *)xmalloc(snapshot_capacity * sizeof(uint64_t));
+        snapshots.covered_spot_counts = (uint16_t *)xmalloc(snapshot_capacity * sizeof(uint16_t));
+        copy_level_state(state, &snapshots.rebuilt_state);
+        take_stress_snapshot(&snapshots, &verifier, 0ULL);
+
+        uint64_t random_state = seed != 0ULL ? seed : STRESS_DEFAULT_SEED;
+        bool passed = true;
+
+        const double start_seconds = get_tool_seconds();
+
+        for (size_t input_index = 0ULL; input_index < input_count && passed; ++input_index) {
+                const enum Input input = stress_inputs[get_tool_random(&random_state) % STRESS_INPUT_COUNT];
+
+                const size_t last_step_count = step_history->step_count;
+                const size_t last_redo_count = step_history->redo_count;
+                const size_t last_evicted_step_count = step_history->evicted_step_count;
+                const size_t last_move_count = step_history->move_count;
+
+                play_replay_code(&verifier, (uint8_t)input);
+                ++out_statistics->input_count;
+
+                // The snapshots of evicted steps are dropped along with them so that the rest keep lining up
+                const size_t evicted_step_count = step_history->evicted_step_count - last_evicted_step_count;
+                if (evicted_step_count > 0ULL) {
+                        snapshots.length -= evicted_step_count;
+                        memmove(snapshots.entities, &snapshots.entities[evicted_step_count * snapshots.entity_count], snapshots.length * snapshots.entity_count * sizeof(struct EntityState));
+                        memmove(snapshots.player_indices, &snapshots.player_indices[evicted_step_count], snapshots.length * sizeof(uint16_t));
+                        memmove(snapshots.move_counts, &snapshots.move_counts[evicted_step_count], snapshots.length * sizeof(size_t));
+                        memmove(snapshots.state_hashes, &snapshots.state_hashes[evicted_step_count], snapshots.length * sizeof(uint64_t));
+                        memmove(snapshots.covered_spot_counts, &snapshots.covered_spot_counts[evicted_step_count], snapshots.length * sizeof(uint16_t));
+                        out_statistics->evicted_step_count += evicted_step_count;
+                }
+
+                const char *mismatch = NULL;
+                switch (input) {
+                        case INPUT_UNDO: {
+                                if (step_history->step_count == last_step_count) {
+                                        if (last_step_count > 0ULL) {
+                                                mismatch = "step count";
+                                        }
+
+                                        break;
+                                }
+
+                                if (step_history->step_count + 1ULL != last_step_count || get_step_history_length(step_history) + 1ULL != snapshots.length) {
+                                        mismatch = "step count";
+                                        break;
+                                }
+
+                                mismatch = compare_stress_snapshot(&snapshots, &verifier, step_history->step_count);
+                                ++out_statistics->undo_count;
+                                break;
+                        }
+
+                        case INPUT_REDO: {
+                                if (step_history->step_count == last_step_count) {
+                                        if (last_redo_count > 0ULL) {
+                                                mismatch = "step count";
+                                        }
+
+                                        break;
+                                }
+
+                                if (step_history->step_count != last_step_count + 1ULL || get_step_history_length(step_history) + 1ULL != snapshots.length) {
+                                        mismatch = "step count";
+                                        break;
+                                }
+
+                                mismatch = compare_stress_snapshot(&snapshots, &verifier, step_history->step_count);
+                                ++out_statistics->redo_count;
+                                break;
+                        }
+
+                        // Any other input either leaves the steps alone or forgets the undone ones and leaves the
+                        // current one as the latest, which the snapshot of the current step then follows
+                        default: {
+                                const size_t length = get_step_history_length(step_history);
+                                if (length + 1ULL > snapshot_capacity) {
+                                        mismatch = "step count";
+                                        break;
+                                }
+
+                                snapshots.length = length + 1ULL;
+                                take_stress_snapshot(&snapshots, &verifier, step_history->step_count);
+
+                                if (step_history->move_count > last_move_count) {
+                                        ++out_statistics->move_count;
+                                }
+
+                                break;
+                        }
+                }
+
+                if (mismatch != NULL) {
+                        printf(
+                                "        Input %zu, %s at step %zu of %zu, broke the %s history: The %s doesn't match\n",
+                                input_index + 1,
+                                input == INPUT_UNDO ? "an undo" : input == INPUT_REDO ? "a redo" : "a step",
+                                step_history->evicted_step_count + step_history->step_count,
+                                step_history->evicted_step_count + get_step_history_length(step_history),
+                                compact ? "compact" : "full",
+                                mismatch
+                        );
+
+                        passed = false;
+                }
+        }
+
+        out_statistics->seconds = get_tool_seconds() - start_seconds;
+        out_statistics->peak_memory_bytes = get_step_history_memory_size(step_history);
+
+        deinitialize_level_state(&snapshots.rebuilt_state);
+        xfree(snapshots.covered_spot_counts);
+        xfree(snapshots.state_hashes);
+        xfree(snapshots.move_counts);
+        xfree(snapshots.player_indices);
+        xfree(snapshots.entities);
+        deinitialize_replay_verifier(&verifier);
+        return passed;
+}
+
+static bool stress_level(const char *const path, const size_t input_count, const size_t maximum_depth, const uint64_t seed) {
+        struct LevelState state;
+        char *title = NULL;
+        if (!initialize_level_state(&state, path, &title)) {
+                fprintf(stderr, "%s: Failed to load level\n", path);
+                return false;
+        }
+
+        printf("%s \"%s\":\n", path, title);
+
+        bool passed = true;
+        for (int compact = 0; compact <= 1; ++compact) {
+                struct StressStatistics statistics;
+                passed &= stress_level_state(&state, input_count, maximum_depth, compact, seed, &statistics);
+
+                printf(
+                        "        %7s history: %zu inputs, %zu moves, %zu undos and %zu redos checked, %zu steps evicted, %.3lf seconds, %.0lf inputs per second, %.0lf moves per second, %.2lf KiB peak history memory\n",
+                        compact ? "Compact" : "Full",
+                        statistics.input_count,
+                        statistics.move_count,
+                        statistics.undo_count,
+                        statistics.redo_count,
+                        statistics.evicted_step_count,
+                        statistics.seconds,
+                        statistics.seconds > 0.0 ? (double)statistics.input_count / statistics.seconds : 0.0,
+                        statistics.seconds > 0.0 ? (double)statistics.move_count / statistics.seconds : 0.0,
+                        (double)statistics.peak_memory_bytes / 1024.0
+                );
+        }
+
+        deinitialize_level_state(&state);
+        xfree(title);
+        return passed;
+}
+
+int main(int argc, char *argv[]) {
+        size_t input_count = STRESS_DEFAULT_INPUT_COUNT;
+        size_t maximum_depth = STRESS_DEFAULT_MAXIMUM_DEPTH;
+        uint64_t seed = STRESS_DEFAULT_SEED;
+        bool all_passed = true;
+
+        // Levels are only stressed once every option is known, so the options apply to all of them wherever they are
+        const char **const level_arguments = (const char **)xmalloc((size_t)argc * sizeof(const char *));
+        size_t level_count = 0ULL;
+
+        for (int argument_index = 1; argument_index < argc; ++argument_index) {
+                const char *const argument = argv[argument_index];
+
+                if (strcmp(argument, "--inputs") == 0 && argument_index + 1 < argc && is_number(argv[argument_index + 1])) {
+                        input_count = (size_t)strtoull(argv[++argument_index], NULL, 10);
+                        continue;
+                }
+
+                if (strcmp(argument, "--depth") == 0 && argument_index + 1 < argc && is_number(argv[argument_index + 1])) {
+                        // Read first since the macro would step past the argument twice
+                        const size_t given_maximum_depth = (size_t)strtoull(argv[++argument_index], NULL, 10);
+                        maximum_depth = MAXIMUM_VALUE(given_maximum_depth, 1ULL);
+                        continue;
+                }
+
+                if (strcmp(argument, "--seed") == 0 && argument_index + 1 < argc && is_number(argv[argument_index + 1])) {
+                        seed = (uint64_t)strtoull(argv[++argument_index], NULL, 10);
+                        continue;
+                }
+
+                level_arguments[level_count++] = argument;
+        }
+
+        for (size_t level_index = 0ULL; level_index < level_count; ++level_index) {
+                char level_path_buffer[TOOL_LEVEL_PATH_SIZE];
+                all_passed &= stress_level(get_level_argument_path(level_arguments[level_index], level_path_buffer, sizeof(level_path_buffer)), input_count, maximum_depth, seed);
+        }
+
+        char level_path_buffer[TOOL_LEVEL_PATH_SIZE];
+        for (size_t number = 1ULL; level_count == 0ULL && query_default_level_path(number, level_path_buffer, sizeof(level_path_buffer)); ++number) {
+                all_passed &= stress_level(level_path_buffer, input_count, maximum_depth, seed);
+        }
+
+        xfree(level_arguments);
+        flush_memory_leaks();
+        return all_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
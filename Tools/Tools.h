@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+
+// What the command line tools share. Every tool is built from its own list of sources, so all of it is inline
+
+// Fits every level number the tools go through, with the path around it
+#define TOOL_LEVEL_PATH_SIZE 32ULL
+
+static inline double get_tool_seconds(void) {
+        struct timespec time;
+        timespec_get(&time, TIME_UTC);
+        return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+// xorshift64*, the state must never be zero
+static inline uint64_t get_tool_random(uint64_t *const random_state) {
+        *random_state ^= *random_state >> 12U;
+        *random_state ^= *random_state << 25U;
+        *random_state ^= *random_state >> 27U;
+        return *random_state * 0x2545F4914F6CDD1DULL;
+}
+
+static inline bool is_number(const char *const string) {
+        for (const char *character = string; *character != '\0'; ++character) {
+                if (*character < '0' || *character > '9') {
+                        return false;
+                }
+        }
+
+        return *string != '\0';
+}
+
+static inline void format_level_path(const size_t number, char *const out_path, const size_t path_size) {
+        snprintf(out_path, path_size, "Assets/Levels/Level%zu.json", number);
+}
+
+// A level is given either as its number or as the path to it
+static inline const char *get_level_argument_path(const char *const argument, char *const path_buffer, const size_t path_size) {
+        if (!is_number(argument)) {
+                return argument;
+        }
+
+        format_level_path((size_t)strtoull(argument, NULL, 10), path_buffer, path_size);
+        return path_buffer;
+}
+
+// Without any levels given, the tools go through the levels in 'Assets/Levels' until one is missing
+static inline bool query_default_level_path(const size_t number, char *const out_path, const size_t path_size) {
+        format_level_path(number, out_path, path_size);
+
+        FILE *const file = fopen(out_path, "rb");
+        if (file == NULL) {
+                return false;
+        }
+
+        fclose(file);
+        return true;
+}
\ No newline at end of file